@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    AllocationCheck.cpp
+
+    Replaces the global allocation functions with counting versions and checks
+    that ChordAnalyzer::analyseFrame() and SamplerEngine::renderNextBlock()
+    never reach them. Exits with a
+    non-zero code if it does, so it can gate a build.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/Analysis/ChordAnalyzer.h"
+#include "../../Source/Sampler/SamplerEngine.h"
+#include <iostream>
+#include <new>
+#include <cstdlib>
+
+namespace
+{
+    std::atomic<bool> countingAllocations { false };
+    std::atomic<juce::int64> allocationCount { 0 };
+
+    void* countedAllocate(std::size_t size)
+    {
+        if (countingAllocations.load(std::memory_order_relaxed))
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (auto* p = std::malloc(size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size)                { return countedAllocate(size); }
+void* operator new[](std::size_t size)              { return countedAllocate(size); }
+void operator delete(void* p) noexcept              { std::free(p); }
+void operator delete[](void* p) noexcept            { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept     { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept   { std::free(p); }
+
+//==============================================================================
+void runAllocationCheck(const juce::ArgumentList&)
+{
+    constexpr double sampleRate = 44100.0;
+    constexpr int numFrames = 1000;
+
+    // Each preset runs a different StftEngine instantiation
+    for (auto preset : { AnalysisSettings::Preset::standard, AnalysisSettings::Preset::lowLatency, AnalysisSettings::Preset::highResolution })
+    {
+        const auto settings = AnalysisSettings::fromPreset(preset);
+
+        ChordAnalyzer analyzer;
+        analyzer.prepare(sampleRate, settings);
+
+        const int frameSize = analyzer.getFrameSize();
+        juce::AudioBuffer<float> input(2, frameSize);
+        juce::Random random(42);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < frameSize; ++i)
+                input.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        int checksum = 0;
+
+        allocationCount.store(0);
+        countingAllocations.store(true);
+
+        for (int i = 0; i < numFrames; ++i)
+            checksum += analyzer.analyseFrame(input.getArrayOfReadPointers(), 2).chordIndex;
+
+        countingAllocations.store(false);
+
+        const auto allocations = allocationCount.load();
+        std::cout << "ChordAnalyzer::analyseFrame, " << frameSize << "-sample frames, " << analyzer.getFftSize() << "-point FFT: "
+                  << allocations << " allocations in " << numFrames << " frames"
+                  << " (checksum " << checksum << ")" << std::endl;
+
+        if (allocations != 0)
+            juce::ConsoleApplication::fail("analyseFrame allocated on the heap");
+    }
+
+    // A full voice pool with notes starting, stealing and releasing throughout
+    {
+        constexpr int blockSize = 64;
+        constexpr int numBlocks = 2000;
+
+        SamplePool::Sample sample;
+        sample.sampleRate = sampleRate;
+        sample.audio.setSize(2, (int) sampleRate);
+        sample.audio.clear();
+
+        std::vector<SamplePool::Sample> samples;
+        samples.push_back(std::move(sample));
+
+        SamplerEngine engine;
+        engine.prepare(sampleRate, blockSize);
+        engine.setSamplePool(std::make_shared<const SamplePool>(std::move(samples)));
+
+        juce::AudioBuffer<float> output(2, blockSize);
+        std::vector<juce::MidiBuffer> midi(8);
+
+        for (int i = 0; i < (int) midi.size(); ++i)
+            for (int note = 0; note < SamplerEngine::maxVoices / 2; ++note)
+                midi[(size_t) i].addEvent(i % 2 == 0 ? juce::MidiMessage::noteOn(1, 30 + note + i, 0.7f)
+                                                     : juce::MidiMessage::noteOff(1, 30 + note + i - 1),
+                                          note % blockSize);
+
+        allocationCount.store(0);
+        countingAllocations.store(true);
+
+        for (int block = 0; block < numBlocks; ++block)
+            engine.renderNextBlock(output, midi[(size_t) block % midi.size()], 0, blockSize);
+
+        countingAllocations.store(false);
+
+        const auto allocations = allocationCount.load();
+        std::cout << "SamplerEngine::renderNextBlock, " << blockSize << "-sample blocks, " << SamplerEngine::maxVoices << " voices: "
+                  << allocations << " allocations in " << numBlocks << " blocks" << std::endl;
+
+        if (allocations != 0)
+            juce::ConsoleApplication::fail("renderNextBlock allocated on the heap");
+    }
+}
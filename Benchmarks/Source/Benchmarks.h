@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+
+    Entry points for the benchmark commands. Each one prints its results to
+    stdout.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+void runChromaBenchmark(const juce::ArgumentList&);
+void runAllocationCheck(const juce::ArgumentList&);
+void runDecodeBenchmark(const juce::ArgumentList&);
+void runSuiteBenchmark(const juce::ArgumentList&);
+void runSmoothingBenchmark(const juce::ArgumentList&);
+void runSamplerBenchmark(const juce::ArgumentList&);
+void runStreamingBenchmark(const juce::ArgumentList&);
+void runResamplerBenchmark(const juce::ArgumentList&);
+
+//==============================================================================
+/** Times a loop body and returns seconds per iteration. */
+template <typename Body>
+double timeIterations(int numIterations, Body&& body)
+{
+    const auto start = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < numIterations; ++i)
+        body(i);
+
+    return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) / numIterations;
+}
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    ChromaBenchmark.cpp
+
+    Compares the table driven ChromaMapper against detectChord as it was
+    before the mapper existed: heap vectors rebuilt per call, a log2 per peak
+    and a 96-way search over note bounds.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/Analysis/ChordDetection.h"
+#include "../../Source/Analysis/ChromaMapper.h"
+#include <iostream>
+
+namespace
+{
+    // The original implementation, kept verbatim apart from its inputs so the
+    // comparison stays honest.
+    juce::String legacyDetectChord(const std::vector<float>& magnitudes, double sampleRate)
+    {
+        // Note names and chord templates
+        const std::vector<juce::String> noteNames = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+        const std::vector<std::pair<std::vector<int>, juce::String>> chordTemplates = {
+            {{0, 4, 7}, "Major"},
+            {{0, 3, 7}, "Minor"},
+            {{0, 4, 7, 11}, "Major 7th"}
+        };
+
+        // PCP
+        std::vector<float> pitchClassProfile(12, 0.0f);
+        const std::vector<float> noteFrequencies = { 16.35f, 17.32f, 18.35f, 19.45f, 20.60f, 21.83f, 23.12f, 24.50f, 25.96f, 27.50f, 29.14f, 30.87f };
+        std::vector<float> logFrequencies(noteFrequencies.size());
+        std::transform(noteFrequencies.begin(), noteFrequencies.end(), logFrequencies.begin(), [](float freq) { return std::log2(freq); });
+
+        for (int i = 1; i < (int) magnitudes.size() - 1; ++i) {
+            float mag = magnitudes[(size_t) i];
+            if (mag > magnitudes[(size_t) i - 1] && mag > magnitudes[(size_t) i + 1])
+            {
+                float freq = static_cast<float>(i * sampleRate / (2 * magnitudes.size()));
+                float logFreq = std::log2(freq);
+
+                for (int octave = 0; octave < 8; ++octave) {
+                    for (int nf = 0; nf < 12; ++nf) {
+                        float lowerBoundLog = (logFrequencies[(size_t) nf] + logFrequencies[(size_t) (nf - 1 + 12) % 12]) / 2 + octave;
+                        float upperBoundLog = (logFrequencies[(size_t) nf] + logFrequencies[(size_t) (nf + 1) % 12]) / 2 + octave;
+                        if (logFreq > lowerBoundLog && logFreq <= upperBoundLog) {
+                            pitchClassProfile[(size_t) nf] += mag;
+                        }
+                    }
+                }
+            }
+        }
+
+        juce::String bestChord;
+        float bestScore = 0.0f;
+
+        for (int rootNote = 0; rootNote < 12; ++rootNote)
+        {
+            for (const auto& templateChord : chordTemplates)
+            {
+                float score = 0.0f;
+                for (int note : templateChord.first)
+                    score += pitchClassProfile[(size_t) (rootNote + note) % 12];
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestChord = noteNames[(size_t) rootNote] + " " + templateChord.second;
+                }
+            }
+        }
+
+        return bestChord;
+    }
+
+    // Magnitude spectra of random triads, so both paths see realistic peak counts
+    std::vector<std::vector<float>> makeSpectra(int numSpectra, int fftOrder, double sampleRate)
+    {
+        const int fftSize = 1 << fftOrder;
+        juce::dsp::FFT fft(fftOrder);
+        juce::Random random(1234);
+
+        std::vector<std::vector<float>> spectra;
+
+        for (int s = 0; s < numSpectra; ++s)
+        {
+            std::vector<float> data((size_t) fftSize * 2, 0.0f);
+            const int root = 48 + random.nextInt(12);
+            const int notes[] = { root, root + (random.nextBool() ? 4 : 3), root + 7 };
+
+            for (int note : notes)
+            {
+                const double freq = 440.0 * std::pow(2.0, (note - 69) / 12.0);
+
+                for (int harmonic = 1; harmonic <= 6; ++harmonic)
+                    for (int i = 0; i < fftSize; ++i)
+                        data[(size_t) i] += (float) (std::sin(juce::MathConstants<double>::twoPi * freq * harmonic * i / sampleRate) / harmonic);
+            }
+
+            for (int i = 0; i < fftSize; ++i)
+                data[(size_t) i] *= 0.5f * (1.0f - std::cos(juce::MathConstants<float>::twoPi * (float) i / (float) (fftSize - 1)));
+
+            fft.performFrequencyOnlyForwardTransform(data.data());
+            data.resize((size_t) fftSize / 2);
+            spectra.push_back(std::move(data));
+        }
+
+        return spectra;
+    }
+}
+
+void runChromaBenchmark(const juce::ArgumentList& args)
+{
+    const int numIterations = args.size() > 1 ? juce::jmax(1, args[1].text.getIntValue()) : 20000;
+    constexpr int fftOrder = 12;
+    constexpr double sampleRate = 44100.0;
+
+    const auto spectra = makeSpectra(64, fftOrder, sampleRate);
+    const int numSpectra = (int) spectra.size();
+
+    ChromaMapper mapper;
+    mapper.prepare(sampleRate, fftOrder);
+    std::vector<float> peakScratch((size_t) mapper.getNumBins());
+    float pitchClassProfile[12];
+
+    int checksum = 0;
+
+    const double legacySeconds = timeIterations(numIterations, [&](int i)
+    {
+        checksum += legacyDetectChord(spectra[(size_t) (i % numSpectra)], sampleRate).length();
+    });
+
+    const double mapperSeconds = timeIterations(numIterations, [&](int i)
+    {
+        mapper.computePitchClassProfile(spectra[(size_t) (i % numSpectra)].data(), pitchClassProfile, peakScratch.data());
+        checksum += ChordDetection::matchChord(pitchClassProfile);
+    });
+
+    // Template matching on its own, against the FFT that precedes it
+    const double matchSeconds = timeIterations(numIterations, [&](int i)
+    {
+        pitchClassProfile[i % 12] += 1.0f;
+        checksum += ChordDetection::matchChord(pitchClassProfile);
+    });
+
+    juce::dsp::FFT fft(fftOrder);
+    std::vector<float> fftData((size_t) (2 << fftOrder), 0.0f);
+
+    const double fftSeconds = timeIterations(numIterations, [&](int i)
+    {
+        std::copy(spectra[(size_t) (i % numSpectra)].begin(), spectra[(size_t) (i % numSpectra)].end(), fftData.begin());
+        fft.performFrequencyOnlyForwardTransform(fftData.data());
+    });
+
+    std::cout << "PCP + template match, " << (1 << fftOrder) << "-point FFT at " << sampleRate << " Hz, "
+              << numIterations << " frames" << std::endl
+              << "  detectChord (original): " << 1.0 / legacySeconds << " frames/sec, " << legacySeconds * 1.0e9 << " ns/frame" << std::endl
+              << "  ChromaMapper:           " << 1.0 / mapperSeconds << " frames/sec, " << mapperSeconds * 1.0e9 << " ns/frame" << std::endl
+              << "  speed-up:               " << legacySeconds / mapperSeconds << "x" << std::endl
+              << "  match only (" << ChordDetection::getNumChords() << " chords): " << matchSeconds * 1.0e9 << " ns/frame"
+              << ", FFT only: " << fftSeconds * 1.0e9 << " ns/frame" << std::endl
+              << "  (checksum " << checksum << ")" << std::endl;
+}
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    DecodeBenchmark.cpp
+
+    Decode throughput of the offline frame loop: the original seek-per-frame
+    pattern through AudioFormatReaderSource against StreamingFrameSource.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/Analysis/AudioFileReaders.h"
+#include "../../Source/Analysis/StreamingFrameSource.h"
+#include <iostream>
+
+namespace
+{
+    constexpr int frameSize = 4096;
+
+    struct DecodeResult
+    {
+        double seconds = 0.0;
+        juce::int64 frames = 0;
+    };
+
+    // What chordDetectionButtonClicked used to do: reposition the source, then pull a block
+    DecodeResult decodeWithSeeks(juce::AudioFormatReader& reader, int hopSize)
+    {
+        juce::AudioFormatReaderSource source(&reader, false);
+        juce::AudioBuffer<float> buffer(2, frameSize);
+
+        DecodeResult result;
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (juce::int64 position = 0; position + frameSize <= source.getTotalLength(); position += hopSize)
+        {
+            source.setNextReadPosition(position);
+            source.getNextAudioBlock(juce::AudioSourceChannelInfo(buffer));
+            ++result.frames;
+        }
+
+        result.seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return result;
+    }
+
+    DecodeResult decodeStreaming(juce::AudioFormatReader& reader, int hopSize)
+    {
+        StreamingFrameSource source(reader, frameSize, hopSize);
+        source.reset(0);
+
+        DecodeResult result;
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        while (source.readNextFrame())
+            ++result.frames;
+
+        result.seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        return result;
+    }
+}
+
+void runDecodeBenchmark(const juce::ArgumentList& args)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    if (args.size() < 2)
+        juce::ConsoleApplication::fail("Give one or more audio files to decode, e.g. a WAV and an MP3");
+
+    for (int i = 1; i < args.size(); ++i)
+    {
+        const auto file = args[i].resolveAsFile();
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+        if (reader == nullptr)
+        {
+            std::cout << file.getFullPathName() << ": can't read" << std::endl;
+            continue;
+        }
+
+        std::cout << file.getFileName() << " (" << reader->getFormatName() << ", "
+                  << reader->lengthInSamples / reader->sampleRate << " s)" << std::endl;
+
+        // The old fixed half-second step, and half-frame overlap as the live path uses
+        for (int hopSize : { (int) (reader->sampleRate * 0.5), frameSize / 2 })
+        {
+            const auto seeking = decodeWithSeeks(*reader, hopSize);
+            const auto streaming = decodeStreaming(*reader, hopSize);
+            const auto fileSamples = (double) reader->lengthInSamples;
+
+            std::cout << "  hop " << hopSize << ": seek per frame " << fileSamples / seeking.seconds << " samples/sec"
+                      << ", streaming " << fileSamples / streaming.seconds << " samples/sec"
+                      << " (" << seeking.seconds / streaming.seconds << "x, " << streaming.frames << " frames)" << std::endl;
+        }
+
+        // WAV/AIFF again through the memory-mapped reader the plugin now uses
+        auto mappedReader = AudioFileReaders::createReaderFor(formatManager, file);
+
+        if (mappedReader != nullptr && AudioFileReaders::isMemoryMapped(*mappedReader))
+        {
+            const auto mapped = decodeStreaming(*mappedReader, frameSize / 2);
+            std::cout << "  hop " << frameSize / 2 << ": streaming, memory-mapped "
+                      << (double) mappedReader->lengthInSamples / mapped.seconds << " samples/sec" << std::endl;
+        }
+    }
+}
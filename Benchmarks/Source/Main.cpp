@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Command-line benchmarks for the chord analysis code in Source/Analysis.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Benchmarks.h"
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ConsoleApplication app;
+
+    app.addHelpCommand("--help|-h", "Usage: ChordBenchmarks <command>", true);
+
+    app.addCommand({ "chroma", "chroma [iterations]",
+                     "PCP + match throughput: ChromaMapper against the original detectChord",
+                     "Runs both implementations over the same synthetic magnitude spectra and prints frames/sec.",
+                     runChromaBenchmark });
+
+    app.addCommand({ "alloc", "alloc",
+                     "Checks that ChordAnalyzer::analyseFrame and SamplerEngine::renderNextBlock do no heap allocation",
+                     "Counts calls to the global operator new while analysing frames and fails if there are any.",
+                     runAllocationCheck });
+
+    app.addCommand({ "decode", "decode <file>...",
+                     "Decode throughput: seek-per-frame against StreamingFrameSource",
+                     "Reads each file as the offline analysis does, once seeking for every frame and once streaming, and prints samples/sec.",
+                     runDecodeBenchmark });
+
+    app.addCommand({ "suite", "suite [--frames=n] [--takes=n] [--chroma=peaks|cq] [--json=file] [--min-accuracy=x]",
+                     "Per-stage speed and recognition accuracy on synthetic chords",
+                     "Times frame read, window, FFT, chroma and match at 44.1, 48 and 96 kHz, then scores every chord in the "
+                     "dictionary under clean, detuned and noisy conditions. --chroma=cq uses the constant-Q front end. --json writes the results for comparing builds; "
+                     "--min-accuracy fails if the overall exact accuracy is lower.",
+                     runSuiteBenchmark });
+
+    app.addCommand({ "smooth", "smooth [--hours=n] [--fps=n] [--lag=n] [--noise=x]",
+                     "Viterbi smoothing speed and accuracy on hours of synthetic chord scores",
+                     "Decodes a noisy random progression over the whole dictionary with ChordSmoother::decode() and the "
+                     "fixed-lag online decoder, compares both with the unsmoothed winners, and checks the structured "
+                     "decoder against a dense O(T.K^2) Viterbi on a prefix.",
+                     runSmoothingBenchmark });
+
+    app.addCommand({ "voices", "voices [--block=n] [--seconds=x]",
+                     "Sampler voices one core can sustain",
+                     "Renders 8, 16, 32 and 64 simultaneous SamplerEngine voices in 64-sample blocks (or --block) at 48 kHz "
+                     "and prints the share of a core each needs and the voices per core that implies.",
+                     runSamplerBenchmark });
+
+    app.addCommand({ "stream", "stream <file>... [--block=n] [--seconds=x] [--read-ahead=x]",
+                     "Transport callback times with and without the read-ahead buffer",
+                     "Pulls 64-sample blocks (or --block) at real-time pace for 10 seconds (or --seconds), decoding in "
+                     "the callback and then through ReadAheadAudioSource, and prints callback times against the deadline "
+                     "and the read-ahead underruns.",
+                     runStreamingBenchmark });
+
+    app.addCommand({ "resample", "resample [--seconds=x]",
+                     "PolyphaseResampler against juce::ResamplingAudioSource",
+                     "Converts a stereo 1 kHz tone from 44.1 to 48 kHz, 48 to 44.1 kHz and 96 to 44.1 kHz at each "
+                     "PolyphaseResampler quality and with ResamplingAudioSource, and prints the CPU cost per channel "
+                     "and the signal to error ratio.",
+                     runResamplerBenchmark });
+
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    ResamplerBenchmark.cpp
+
+    PolyphaseResampler at each quality against juce::ResamplingAudioSource,
+    converting a stereo 1 kHz sine between common rates in 512-sample
+    blocks. Prints the CPU cost per channel (ns per output sample and the
+    number of channels one core could convert in real time) and the
+    signal-to-error ratio against the exact sine at the output rate.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/Playback/PolyphaseResampler.h"
+#include <iostream>
+
+namespace
+{
+    constexpr int numChannels = 2, blockSize = 512;
+    constexpr double toneHz = 1000.0;
+
+    juce::AudioBuffer<float> createTone(double sampleRate, int numSamples)
+    {
+        juce::AudioBuffer<float> tone(numChannels, numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                tone.setSample(channel, i, (float) std::sin(juce::MathConstants<double>::twoPi * toneHz * i / sampleRate));
+
+        return tone;
+    }
+
+    // Against the exact tone, skipping the edges and the converter's delay
+    double getSignalToErrorDb(const juce::AudioBuffer<float>& output, double outputRate, int delaySamples)
+    {
+        double signal = 0.0, error = 0.0;
+
+        for (int i = 1000; i < output.getNumSamples() - 1000; ++i)
+        {
+            const double expected = std::sin(juce::MathConstants<double>::twoPi * toneHz * (i - delaySamples) / outputRate);
+            const double difference = output.getSample(0, i) - expected;
+            signal += expected * expected;
+            error += difference * difference;
+        }
+
+        return 10.0 * std::log10(signal / juce::jmax(error, 1.0e-30));
+    }
+
+    // ResamplingAudioSource's output lags the input; find the lag that fits best
+    int findDelay(const juce::AudioBuffer<float>& output, double outputRate)
+    {
+        int best = 0;
+        double bestDb = -1000.0;
+
+        for (int delay = 0; delay < 64; ++delay)
+        {
+            const auto db = getSignalToErrorDb(output, outputRate, delay);
+
+            if (db > bestDb)
+            {
+                bestDb = db;
+                best = delay;
+            }
+        }
+
+        return best;
+    }
+
+    void printResult(const juce::String& name, double secondsPerBlock, double outputRate, double signalToErrorDb)
+    {
+        const auto nsPerSample = secondsPerBlock * 1.0e9 / (blockSize * numChannels);
+        const auto channelsPerCore = 1.0e9 / (nsPerSample * outputRate);
+
+        std::cout << "  " << name.paddedRight(' ', 14) << juce::String(nsPerSample, 2) << " ns per sample per channel, ~"
+                  << juce::String(channelsPerCore, 0) << " channels per core, " << juce::String(signalToErrorDb, 1)
+                  << " dB signal to error" << std::endl;
+    }
+}
+
+void runResamplerBenchmark(const juce::ArgumentList& args)
+{
+    const auto secondsOption = args.getValueForOption("--seconds");
+    const double seconds = secondsOption.isNotEmpty() ? juce::jmax(0.5, secondsOption.getDoubleValue()) : 5.0;
+
+    const std::pair<double, double> conversions[] = { { 44100.0, 48000.0 }, { 48000.0, 44100.0 }, { 96000.0, 44100.0 } };
+
+    for (auto [inputRate, outputRate] : conversions)
+    {
+        const double ratio = inputRate / outputRate;
+        const int numBlocks = juce::roundToInt(seconds * outputRate / blockSize);
+        auto input = createTone(inputRate, (int) std::ceil(numBlocks * blockSize * ratio) + 1024);
+        juce::AudioBuffer<float> output(numChannels, numBlocks * blockSize);
+
+        std::cout << inputRate << " Hz to " << outputRate << " Hz, stereo, " << seconds << " s" << std::endl;
+
+        for (auto quality : { PolyphaseResampler::Quality::draft, PolyphaseResampler::Quality::normal, PolyphaseResampler::Quality::high })
+        {
+            PolyphaseResampler resampler;
+            resampler.prepare(numChannels, ratio, quality, blockSize);
+            int inputPosition = 0;
+
+            const auto secondsPerBlock = timeIterations(numBlocks, [&](int block)
+            {
+                const float* inputs[] = { input.getReadPointer(0, inputPosition), input.getReadPointer(1, inputPosition) };
+                float* outputs[] = { output.getWritePointer(0, block * blockSize), output.getWritePointer(1, block * blockSize) };
+
+                inputPosition += resampler.getNumInputNeeded(blockSize);
+                resampler.process(inputs, outputs, blockSize);
+            });
+
+            printResult("Polyphase " + PolyphaseResampler::getQualityNames()[(int) quality - 1],
+                        secondsPerBlock, outputRate, getSignalToErrorDb(output, outputRate, 0));
+        }
+
+        {
+            juce::MemoryAudioSource memorySource(input, false);
+            juce::ResamplingAudioSource resamplingSource(&memorySource, false, numChannels);
+            resamplingSource.setResamplingRatio(ratio);
+            resamplingSource.prepareToPlay(blockSize, outputRate);
+
+            const auto secondsPerBlock = timeIterations(numBlocks, [&](int block)
+            {
+                resamplingSource.getNextAudioBlock(juce::AudioSourceChannelInfo(&output, block * blockSize, blockSize));
+            });
+
+            printResult("JUCE", secondsPerBlock, outputRate, getSignalToErrorDb(output, outputRate, findDelay(output, outputRate)));
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    SamplerBenchmark.cpp
+
+    How many SamplerEngine voices one core can sustain. A stereo sample is
+    played by N simultaneous notes spread over three octaves around its root
+    (so every voice resamples at a different rate) and rendered in small
+    blocks for a few seconds of audio; the time taken against the audio's
+    duration gives the load of one core, and N divided by that load the
+    voices per core.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/Sampler/SamplerEngine.h"
+#include <iostream>
+
+namespace
+{
+    std::shared_ptr<const SamplePool> createTestPool(double sampleRate, double seconds)
+    {
+        SamplePool::Sample sample;
+        sample.name = "test";
+        sample.sampleRate = sampleRate;
+        sample.rootNote = SamplePool::defaultRootNote;
+        sample.audio.setSize(2, juce::roundToInt(sampleRate * seconds));
+
+        juce::Random random(3);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < sample.audio.getNumSamples(); ++i)
+                sample.audio.setSample(channel, i, 0.5f * std::sin(0.05f * (float) i * (1.0f + 0.01f * (float) channel))
+                                                   + 0.1f * (random.nextFloat() - 0.5f));
+
+        std::vector<SamplePool::Sample> samples;
+        samples.push_back(std::move(sample));
+        return std::make_shared<const SamplePool>(std::move(samples));
+    }
+}
+
+void runSamplerBenchmark(const juce::ArgumentList& args)
+{
+    const auto blockOption = args.getValueForOption("--block");
+    const auto secondsOption = args.getValueForOption("--seconds");
+    const int blockSize = blockOption.isNotEmpty() ? juce::jmax(1, blockOption.getIntValue()) : 64;
+    const double seconds = secondsOption.isNotEmpty() ? juce::jmax(0.1, secondsOption.getDoubleValue()) : 2.0;
+    constexpr double sampleRate = 48000.0;
+
+    // The highest note reads almost 4x faster than the root, so this keeps every voice sounding
+    const auto pool = createTestPool(sampleRate, seconds * 8.0 + 1.0);
+    const int numBlocks = juce::roundToInt(seconds * sampleRate / blockSize);
+
+    std::cout << "SamplerEngine, " << blockSize << "-sample blocks at " << sampleRate << " Hz, stereo sample, "
+              << seconds << " s per run" << std::endl;
+
+    for (int numVoices = 8; numVoices <= SamplerEngine::maxVoices; numVoices *= 2)
+    {
+        SamplerEngine engine;
+        engine.prepare(sampleRate, blockSize);
+        engine.setSamplePool(pool);
+        engine.setEnvelope({ 0.01f, 0.1f, 0.8f, 0.2f });
+
+        juce::AudioBuffer<float> output(2, blockSize);
+        juce::MidiBuffer noteOns, noMidi;
+
+        for (int voice = 0; voice < numVoices; ++voice)
+            noteOns.addEvent(juce::MidiMessage::noteOn(1, 48 + voice % 36, 0.8f), 0);
+
+        const auto secondsPerBlock = timeIterations(numBlocks, [&](int block)
+        {
+            output.clear();
+            engine.renderNextBlock(output, block == 0 ? noteOns : noMidi, 0, blockSize);
+        });
+
+        const auto load = secondsPerBlock / (blockSize / sampleRate);
+
+        std::cout << "  " << juce::String(numVoices).paddedLeft(' ', 2) << " voices (" << engine.getNumActiveVoices() << " sounding): "
+                  << juce::String(load * 100.0, 2) << "% of a core, "
+                  << juce::String(secondsPerBlock * 1.0e9 / (blockSize * numVoices), 2) << " ns per voice-sample, ~"
+                  << juce::String(numVoices / load, 0) << " voices per core" << std::endl;
+    }
+}
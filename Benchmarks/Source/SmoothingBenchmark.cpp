@@ -0,0 +1,236 @@
+/*
+  ==============================================================================
+
+    SmoothingBenchmark.cpp
+
+    Speed and effect of ChordSmoother on a long synthetic score sequence.
+
+    A random chord progression (each chord held for 1-4 seconds) is turned
+    into noisy pitch class profiles and scored against the whole dictionary,
+    giving hours of per-frame scores without any audio. The raw per-frame
+    winners, the exact decode() and the fixed-lag online decoder are then
+    compared for speed, accuracy and number of chord changes, and the
+    structured decoder is checked against a plain O(T.K^2) Viterbi on a
+    prefix of the sequence.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/Analysis/ChordDetection.h"
+#include "../../Source/Analysis/ChordSmoother.h"
+#include "../../Source/Analysis/ChordTemplates.h"
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    constexpr int numChords = ChordSmoother::numChords;
+
+    struct Sequence
+    {
+        int numFrames = 0;
+        std::vector<int> truth;
+        std::vector<float> scores;     // numFrames x numChords
+    };
+
+    Sequence makeSequence(int numFrames, double framesPerSecond, float noise)
+    {
+        juce::Random random(7);
+        Sequence sequence;
+        sequence.numFrames = numFrames;
+        sequence.truth.resize((size_t) numFrames);
+        sequence.scores.resize((size_t) numFrames * numChords);
+
+        int chord = 0, framesLeft = 0;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            if (framesLeft-- <= 0)
+            {
+                chord = random.nextInt(numChords);
+                framesLeft = juce::roundToInt(framesPerSecond * (1.0 + 3.0 * random.nextDouble()));
+            }
+
+            float pitchClassProfile[12];
+            const auto mask = ChordTemplates::getPitchClassMask(chord);
+
+            for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+                pitchClassProfile[pitchClass] = ((mask >> pitchClass) & 1 ? 1.0f : 0.0f) + noise * random.nextFloat();
+
+            sequence.truth[(size_t) frame] = chord;
+            ChordDetection::scoreChords(pitchClassProfile, sequence.scores.data() + (size_t) frame * numChords);
+        }
+
+        return sequence;
+    }
+
+    int countChanges(const int* path, int numFrames)
+    {
+        int changes = 0;
+        for (int i = 1; i < numFrames; ++i)
+            changes += path[i] != path[i - 1] ? 1 : 0;
+        return changes;
+    }
+
+    double getAccuracy(const int* path, const Sequence& sequence, int numFrames)
+    {
+        int correct = 0;
+        for (int i = 0; i < numFrames; ++i)
+            correct += path[i] == sequence.truth[(size_t) i] ? 1 : 0;
+        return numFrames > 0 ? (double) correct / numFrames : 0.0;
+    }
+
+    /** The textbook recursion over a dense K x K transition matrix, as a reference. */
+    void decodeDense(const float* scores, int numFrames, int* path, const ChordSmoother::Parameters& parameters)
+    {
+        std::vector<float> transitions((size_t) numChords * numChords);
+
+        for (int from = 0; from < numChords; ++from)
+            for (int to = 0; to < numChords; ++to)
+                transitions[(size_t) from * numChords + (size_t) to]
+                    = from == to ? 0.0f
+                                 : -(parameters.changePenalty
+                                      + parameters.rootMotionPenalty[(size_t) ((ChordTemplates::getRoot(to) - ChordTemplates::getRoot(from) + 12) % 12)]);
+
+        std::vector<int> back((size_t) numFrames * numChords);
+        std::vector<float> current((size_t) numChords), next((size_t) numChords);
+
+        for (int chord = 0; chord < numChords; ++chord)
+            current[(size_t) chord] = parameters.emissionScale * scores[chord];
+
+        for (int frame = 1; frame < numFrames; ++frame)
+        {
+            for (int to = 0; to < numChords; ++to)
+            {
+                float best = -std::numeric_limits<float>::max();
+                int bestFrom = 0;
+
+                for (int from = 0; from < numChords; ++from)
+                {
+                    const float value = current[(size_t) from] + transitions[(size_t) from * numChords + (size_t) to];
+                    if (value > best)
+                    {
+                        best = value;
+                        bestFrom = from;
+                    }
+                }
+
+                next[(size_t) to] = best + parameters.emissionScale * scores[(size_t) frame * numChords + (size_t) to];
+                back[(size_t) frame * numChords + (size_t) to] = bestFrom;
+            }
+
+            const float largest = *std::max_element(next.begin(), next.end());
+            for (auto& value : next)
+                value -= largest;
+
+            std::swap(current, next);
+        }
+
+        int chord = (int) (std::max_element(current.begin(), current.end()) - current.begin());
+
+        for (int frame = numFrames - 1; frame >= 0; --frame)
+        {
+            path[frame] = chord;
+            chord = back[(size_t) frame * numChords + (size_t) chord];
+        }
+    }
+
+    void printResult(const char* name, double seconds, const int* path, const Sequence& sequence, double framesPerSecond)
+    {
+        const auto audioHours = sequence.numFrames / framesPerSecond / 3600.0;
+
+        std::cout << "  " << name << juce::String(getAccuracy(path, sequence, sequence.numFrames) * 100.0, 1) << "% correct, "
+                  << countChanges(path, sequence.numFrames) << " changes";
+
+        if (seconds > 0.0)
+            std::cout << ", " << juce::String(seconds * 1000.0, 1) << " ms ("
+                      << juce::String(seconds * 1.0e9 / sequence.numFrames, 0) << " ns/frame, "
+                      << juce::String(audioHours / (seconds / 60.0), 0) << " audio-hours per minute)";
+
+        std::cout << std::endl;
+    }
+}
+
+void runSmoothingBenchmark(const juce::ArgumentList& args)
+{
+    const auto hoursOption = args.getValueForOption("--hours");
+    const auto fpsOption = args.getValueForOption("--fps");
+    const auto lagOption = args.getValueForOption("--lag");
+    const auto noiseOption = args.getValueForOption("--noise");
+
+    const double hours = hoursOption.isNotEmpty() ? juce::jmax(0.01, hoursOption.getDoubleValue()) : 1.0;
+    const double framesPerSecond = fpsOption.isNotEmpty() ? juce::jmax(1.0, fpsOption.getDoubleValue()) : 10.0;
+    const int lag = lagOption.isNotEmpty() ? juce::jmax(0, lagOption.getIntValue()) : ChordSmoother::defaultLagFrames;
+    const float noise = noiseOption.isNotEmpty() ? (float) noiseOption.getDoubleValue() : 0.8f;
+
+    const int numFrames = juce::roundToInt(hours * 3600.0 * framesPerSecond);
+    const auto sequence = makeSequence(numFrames, framesPerSecond, noise);
+
+    std::cout << numFrames << " frames (" << hours << " h at " << framesPerSecond << " frames/sec), "
+              << numChords << " chords, noise " << noise << std::endl;
+
+    std::vector<int> path((size_t) numFrames);
+
+    // Per-frame winners, as the analysis does without smoothing
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        const auto* row = sequence.scores.data() + (size_t) frame * numChords;
+        path[(size_t) frame] = (int) (std::max_element(row, row + numChords) - row);
+    }
+
+    printResult("unsmoothed:   ", 0.0, path.data(), sequence, framesPerSecond);
+
+    const auto exactSeconds = timeIterations(1, [&](int)
+    {
+        ChordSmoother::decode(sequence.scores.data(), numFrames, path.data());
+    });
+
+    printResult("decode():     ", exactSeconds, path.data(), sequence, framesPerSecond);
+
+    ChordSmoother smoother;
+    smoother.prepare(lag);
+    std::vector<ChordSmoother::Decision> lastDecisions((size_t) lag);
+
+    const auto onlineSeconds = timeIterations(1, [&](int)
+    {
+        int decided = 0;
+        ChordSmoother::Decision decision;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+            if (smoother.push(sequence.scores.data() + (size_t) frame * numChords, decision))
+                path[(size_t) decided++] = decision.chordIndex;
+
+        const int numLeft = smoother.flush(lastDecisions.data());
+        for (int i = 0; i < numLeft; ++i)
+            path[(size_t) decided++] = lastDecisions[(size_t) i].chordIndex;
+    });
+
+    const auto label = "lag " + juce::String(lag).paddedRight(' ', 10) + ": ";
+    printResult(label.toRawUTF8(), onlineSeconds, path.data(), sequence, framesPerSecond);
+
+    // The dense reference is O(T.K^2), so it only gets a prefix
+    const int numReferenceFrames = juce::jmin(numFrames, 2000);
+    std::vector<int> referencePath((size_t) numReferenceFrames), structuredPath((size_t) numReferenceFrames);
+
+    const auto denseSeconds = timeIterations(1, [&](int)
+    {
+        decodeDense(sequence.scores.data(), numReferenceFrames, referencePath.data(), ChordSmoother::Parameters());
+    });
+
+    const auto structuredSeconds = timeIterations(1, [&](int)
+    {
+        ChordSmoother::decode(sequence.scores.data(), numReferenceFrames, structuredPath.data());
+    });
+
+    int agreeing = 0;
+    for (int i = 0; i < numReferenceFrames; ++i)
+        agreeing += referencePath[(size_t) i] == structuredPath[(size_t) i] ? 1 : 0;
+
+    std::cout << "Dense O(T.K^2) reference over " << numReferenceFrames << " frames: "
+              << juce::String(denseSeconds * 1.0e9 / numReferenceFrames, 0) << " ns/frame against "
+              << juce::String(structuredSeconds * 1.0e9 / numReferenceFrames, 0) << " ns/frame ("
+              << juce::String(denseSeconds / structuredSeconds, 1) << "x), paths agree on "
+              << juce::String(100.0 * agreeing / juce::jmax(1, numReferenceFrames), 2) << "% of frames" << std::endl;
+}
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    StreamingBenchmark.cpp
+
+    Transport playback as the audio thread sees it: blocks are pulled at the
+    pace of a real-time callback, once straight from AudioFormatReaderSource
+    (decoding inside the callback, as playback used to) and once through
+    ReadAheadAudioSource. Reports how long each callback took against its
+    deadline and how often the read-ahead buffer ran dry.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "../../Source/Analysis/AudioFileReaders.h"
+#include "../../Source/Playback/ReadAheadAudioSource.h"
+#include <iostream>
+
+namespace
+{
+    struct CallbackStats
+    {
+        double meanMs = 0.0, worstMs = 0.0;
+        int numLate = 0, numBlocks = 0;
+    };
+
+    // Calls the source once per block period, as an audio device would
+    CallbackStats pullInRealTime(juce::AudioSource& source, int blockSize, double sampleRate, double seconds)
+    {
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        const double blockMs = 1000.0 * blockSize / sampleRate;
+        const int numBlocks = juce::roundToInt(seconds * sampleRate / blockSize);
+
+        CallbackStats stats;
+        stats.numBlocks = numBlocks;
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // Sleep most of the way to the next callback, then spin
+            const auto due = start + block * blockMs;
+
+            for (auto now = juce::Time::getMillisecondCounterHiRes(); now < due; now = juce::Time::getMillisecondCounterHiRes())
+            {
+                if (due - now > 2.0)
+                    juce::Thread::sleep(1);
+                else
+                    juce::Thread::yield();
+            }
+
+            const auto callbackStart = juce::Time::getMillisecondCounterHiRes();
+            source.getNextAudioBlock(juce::AudioSourceChannelInfo(buffer));
+            const auto callbackMs = juce::Time::getMillisecondCounterHiRes() - callbackStart;
+
+            stats.meanMs += callbackMs / numBlocks;
+            stats.worstMs = juce::jmax(stats.worstMs, callbackMs);
+            stats.numLate += callbackMs > blockMs ? 1 : 0;
+        }
+
+        return stats;
+    }
+
+    void printStats(const char* name, const CallbackStats& stats)
+    {
+        std::cout << "  " << name << ": mean " << juce::String(stats.meanMs * 1000.0, 1) << " us, worst "
+                  << juce::String(stats.worstMs * 1000.0, 1) << " us, " << stats.numLate << " of "
+                  << stats.numBlocks << " callbacks over the deadline" << std::endl;
+    }
+}
+
+void runStreamingBenchmark(const juce::ArgumentList& args)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    const auto blockOption = args.getValueForOption("--block");
+    const auto secondsOption = args.getValueForOption("--seconds");
+    const auto readAheadOption = args.getValueForOption("--read-ahead");
+    const int blockSize = blockOption.isNotEmpty() ? juce::jmax(16, blockOption.getIntValue()) : 64;
+    const double seconds = secondsOption.isNotEmpty() ? juce::jmax(0.5, secondsOption.getDoubleValue()) : 10.0;
+    const double readAheadSeconds = readAheadOption.isNotEmpty() ? juce::jmax(0.01, readAheadOption.getDoubleValue())
+                                                                 : ReadAheadAudioSource::defaultReadAheadSeconds;
+
+    juce::Array<juce::File> files;
+    for (int i = 1; i < args.size(); ++i)
+        if (! args[i].isOption())
+            files.add(args[i].resolveAsFile());
+
+    if (files.isEmpty())
+        juce::ConsoleApplication::fail("Give one or more audio files to play, ideally a large WAV and an MP3");
+
+    for (auto& file : files)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(AudioFileReaders::createReaderFor(formatManager, file));
+
+        if (reader == nullptr)
+        {
+            std::cout << file.getFullPathName() << ": can't read" << std::endl;
+            continue;
+        }
+
+        const auto sampleRate = reader->sampleRate;
+        std::cout << file.getFileName() << " (" << reader->getFormatName() << "), " << blockSize << "-sample blocks, "
+                  << juce::jmin(seconds, reader->lengthInSamples / sampleRate) << " s" << std::endl;
+
+        {
+            juce::AudioFormatReaderSource direct(reader.get(), false);
+            direct.prepareToPlay(blockSize, sampleRate);
+            printStats("decoding in the callback", pullInRealTime(direct, blockSize, sampleRate, seconds));
+        }
+
+        {
+            ReadAheadAudioSource readAhead(new juce::AudioFormatReaderSource(reader.get(), false), true,
+                                           juce::roundToInt(readAheadSeconds * sampleRate));
+            readAhead.prepareToPlay(blockSize, sampleRate);
+
+            // Let it pre-roll, as a transport would while stopped
+            for (int waited = 0; readAhead.getFillLevel() < 0.99f && waited < 2000; ++waited)
+                juce::Thread::sleep(1);
+
+            const auto stats = pullInRealTime(readAhead, blockSize, sampleRate, seconds);
+            printStats("read-ahead", stats);
+            std::cout << "  read-ahead " << readAheadSeconds << " s: " << readAhead.getNumUnderruns() << " underruns, "
+                      << juce::roundToInt(readAhead.getFillLevel() * 100.0f) << "% full at the end" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,311 @@
+/*
+  ==============================================================================
+
+    SuiteBenchmark.cpp
+
+    Speed and accuracy of the whole analysis chain on synthetic chords.
+
+    Speed: a sequence of chords is written to an in-memory WAV and every stage
+    of the offline path (frame read, window, FFT, chroma, template match) is
+    run over all of its frames in turn, so each is timed on its own.
+
+    Accuracy: every chord in the dictionary is rendered under several
+    conditions (clean, detuned, noisy) at each sample rate, analysed with
+    ChordAnalyzer, and scored against its label.
+
+    --chroma=cq runs both with the constant-Q front end instead of peak
+    picking, for comparing the two.
+
+    Results can be written as JSON for comparing builds.
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "SyntheticChords.h"
+#include "../../Source/Analysis/ChordAnalyzer.h"
+#include "../../Source/Analysis/ChordDetection.h"
+#include "../../Source/Analysis/ChordTemplates.h"
+#include "../../Source/Analysis/ChromaMapper.h"
+#include "../../Source/Analysis/ConstantQChroma.h"
+#include "../../Source/Analysis/StreamingFrameSource.h"
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    constexpr int fftOrder = ChordAnalyzer::defaultFftOrder;
+    constexpr int frameSize = 1 << fftOrder;
+
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+
+    struct Condition
+    {
+        const char* name;
+        float maxDetuneCents;
+        float snrDb;
+    };
+
+    const Condition conditions[] =
+    {
+        { "clean",          0.0f,   0.0f },
+        { "detuned",        20.0f,  0.0f },
+        { "noisy",          0.0f,   20.0f },
+        { "detuned+noisy",  20.0f,  10.0f }
+    };
+
+    struct StageTimes
+    {
+        double read = 0.0, window = 0.0, fft = 0.0, chroma = 0.0, match = 0.0;     // seconds per frame
+    };
+
+    struct Accuracy
+    {
+        int total = 0, exact = 0, rootCorrect = 0;
+
+        double getExact() const noexcept    { return total > 0 ? (double) exact / total : 0.0; }
+        double getRoot() const noexcept     { return total > 0 ? (double) rootCorrect / total : 0.0; }
+    };
+
+    std::unique_ptr<juce::AudioFormatReader> createWavReader(const juce::AudioBuffer<float>& signal, double sampleRate, juce::MemoryBlock& wavData)
+    {
+        juce::WavAudioFormat wav;
+
+        {
+            std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(new juce::MemoryOutputStream(wavData, false),
+                                                                                sampleRate, (unsigned int) signal.getNumChannels(), 24, {}, 0));
+            if (writer == nullptr)
+                return {};
+
+            writer->writeFromAudioSampleBuffer(signal, 0, signal.getNumSamples());
+        }
+
+        return std::unique_ptr<juce::AudioFormatReader>(wav.createReaderFor(new juce::MemoryInputStream(wavData, false), true));
+    }
+
+    StageTimes timeStages(double sampleRate, int numFrames, AnalysisSettings::Chroma chroma)
+    {
+        const bool useConstantQ = chroma == AnalysisSettings::Chroma::constantQ;
+
+        juce::Random random(42);
+        SyntheticChordSettings settings;
+        settings.sampleRate = sampleRate;
+
+        // One chord per frame, frames back to back
+        juce::AudioBuffer<float> signal(2, numFrames * frameSize);
+        for (int i = 0; i < numFrames; ++i)
+            renderSyntheticChord(i % ChordTemplates::numChords, settings, random, signal, i * frameSize, frameSize);
+
+        juce::MemoryBlock wavData;
+        auto reader = createWavReader(signal, sampleRate, wavData);
+        if (reader == nullptr)
+            juce::ConsoleApplication::fail("Couldn't create the test WAV");
+
+        juce::AudioBuffer<float> frames(2, numFrames * frameSize);
+        std::vector<float> fftData((size_t) numFrames * frameSize * 2, 0.0f);
+        std::vector<float> pitchClassProfiles((size_t) numFrames * 12);
+
+        std::vector<float> window((size_t) frameSize);
+        for (int i = 0; i < frameSize; ++i)
+            window[(size_t) i] = 0.5f * (1 - std::cos((2 * juce::MathConstants<float>::pi * i) / (frameSize - 1)));
+
+        juce::dsp::FFT fft(fftOrder);
+        ChromaMapper mapper;
+        mapper.prepare(sampleRate, fftOrder);
+        std::vector<float> peakScratch((size_t) mapper.getNumBins());
+        ConstantQChroma constantQ;
+        constantQ.prepare(sampleRate, fftOrder, frameSize);
+
+        StageTimes times;
+        StreamingFrameSource source(*reader, frameSize, frameSize);
+        source.reset(0);
+
+        times.read = timeIterations(numFrames, [&](int i)
+        {
+            source.readNextFrame();
+            for (int channel = 0; channel < 2; ++channel)
+                frames.copyFrom(channel, i * frameSize, source.getFrame()[channel], frameSize);
+        });
+
+        times.window = timeIterations(numFrames, [&](int i)
+        {
+            auto* data = fftData.data() + (size_t) i * frameSize * 2;
+            juce::FloatVectorOperations::add(data, frames.getReadPointer(0, i * frameSize), frames.getReadPointer(1, i * frameSize), frameSize);
+
+            // The constant-Q kernels are windowed already
+            if (! useConstantQ)
+                juce::FloatVectorOperations::multiply(data, window.data(), frameSize);
+        });
+
+        times.fft = timeIterations(numFrames, [&](int i)
+        {
+            auto* data = fftData.data() + (size_t) i * frameSize * 2;
+
+            if (useConstantQ)
+                fft.performRealOnlyForwardTransform(data, true);
+            else
+                fft.performFrequencyOnlyForwardTransform(data);
+        });
+
+        times.chroma = timeIterations(numFrames, [&](int i)
+        {
+            auto* data = fftData.data() + (size_t) i * frameSize * 2;
+            auto* pitchClassProfile = pitchClassProfiles.data() + (size_t) i * 12;
+
+            if (useConstantQ)
+                constantQ.computePitchClassProfile(data, pitchClassProfile);
+            else
+                mapper.computePitchClassProfile(data, pitchClassProfile, peakScratch.data());
+        });
+
+        int checksum = 0;
+        times.match = timeIterations(numFrames, [&](int i)
+        {
+            checksum += ChordDetection::matchChord(pitchClassProfiles.data() + (size_t) i * 12);
+        });
+
+        juce::ignoreUnused(checksum);
+        return times;
+    }
+
+    Accuracy measureAccuracy(double sampleRate, const Condition& condition, int takesPerChord, AnalysisSettings::Chroma chroma)
+    {
+        juce::Random random(1234);
+        SyntheticChordSettings settings;
+        settings.sampleRate = sampleRate;
+        settings.maxDetuneCents = condition.maxDetuneCents;
+        settings.snrDb = condition.snrDb;
+
+        ChordAnalyzer analyzer;
+        AnalysisSettings analysisSettings;
+        analysisSettings.fftOrder = fftOrder;
+        analysisSettings.frameOrder = fftOrder;
+        analysisSettings.chroma = chroma;
+        analyzer.prepare(sampleRate, analysisSettings);
+        juce::AudioBuffer<float> frame(1, frameSize);
+
+        Accuracy accuracy;
+
+        for (int chord = 0; chord < ChordTemplates::numChords; ++chord)
+        {
+            for (int take = 0; take < takesPerChord; ++take)
+            {
+                renderSyntheticChord(chord, settings, random, frame, 0, frameSize);
+                const auto detected = analyzer.analyseFrame(frame.getArrayOfReadPointers(), 1).chordIndex;
+
+                ++accuracy.total;
+                accuracy.exact += detected == chord ? 1 : 0;
+                accuracy.rootCorrect += detected >= 0 && ChordTemplates::getRoot(detected) == ChordTemplates::getRoot(chord) ? 1 : 0;
+            }
+        }
+
+        return accuracy;
+    }
+
+    juce::var describeStage(double secondsPerFrame)
+    {
+        auto* stage = new juce::DynamicObject();
+        stage->setProperty("framesPerSec", 1.0 / secondsPerFrame);
+        stage->setProperty("nsPerFrame", secondsPerFrame * 1.0e9);
+        return juce::var(stage);
+    }
+}
+
+void runSuiteBenchmark(const juce::ArgumentList& args)
+{
+    const auto framesOption = args.getValueForOption("--frames");
+    const auto takesOption = args.getValueForOption("--takes");
+    const int numFrames = framesOption.isNotEmpty() ? juce::jmax(1, framesOption.getIntValue()) : 512;
+    const int takesPerChord = takesOption.isNotEmpty() ? juce::jmax(1, takesOption.getIntValue()) : 2;
+
+    const auto chromaOption = args.getValueForOption("--chroma");
+    if (chromaOption.isNotEmpty() && chromaOption != "peaks" && chromaOption != "cq")
+        juce::ConsoleApplication::fail("Unknown chroma '" + chromaOption + "', expected peaks or cq");
+
+    const auto chroma = chromaOption == "cq" ? AnalysisSettings::Chroma::constantQ : AnalysisSettings::Chroma::peaks;
+
+    auto* results = new juce::DynamicObject();
+    juce::var resultsVar(results);
+    results->setProperty("fftSize", frameSize);
+    results->setProperty("numChords", ChordTemplates::numChords);
+    results->setProperty("chroma", chroma == AnalysisSettings::Chroma::constantQ ? "cq" : "peaks");
+
+    juce::Array<juce::var> stageResults, accuracyResults;
+    Accuracy overall;
+
+    std::cout << "Per-stage throughput, " << frameSize << "-point frames, " << numFrames << " frames, "
+              << (chroma == AnalysisSettings::Chroma::constantQ ? "constant-Q" : "peak-picking") << " chroma" << std::endl;
+
+    for (auto sampleRate : sampleRates)
+    {
+        const auto times = timeStages(sampleRate, numFrames, chroma);
+        const std::pair<const char*, double> stages[] = { { "read", times.read }, { "window", times.window }, { "fft", times.fft },
+                                                          { "chroma", times.chroma }, { "match", times.match } };
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("sampleRate", sampleRate);
+        std::cout << "  " << sampleRate << " Hz:";
+
+        double total = 0.0;
+        for (auto& stage : stages)
+        {
+            entry->setProperty(stage.first, describeStage(stage.second));
+            std::cout << "  " << stage.first << " " << juce::String(stage.second * 1.0e9, 0) << " ns";
+            total += stage.second;
+        }
+
+        entry->setProperty("total", describeStage(total));
+        std::cout << "  = " << juce::String(1.0 / total, 0) << " frames/sec" << std::endl;
+        stageResults.add(juce::var(entry));
+    }
+
+    std::cout << "Accuracy over " << ChordTemplates::numChords << " chords x " << takesPerChord << " takes (exact / root)" << std::endl;
+
+    for (auto sampleRate : sampleRates)
+    {
+        std::cout << "  " << sampleRate << " Hz:";
+
+        for (auto& condition : conditions)
+        {
+            const auto accuracy = measureAccuracy(sampleRate, condition, takesPerChord, chroma);
+
+            overall.total += accuracy.total;
+            overall.exact += accuracy.exact;
+            overall.rootCorrect += accuracy.rootCorrect;
+
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("sampleRate", sampleRate);
+            entry->setProperty("condition", condition.name);
+            entry->setProperty("total", accuracy.total);
+            entry->setProperty("exact", accuracy.getExact());
+            entry->setProperty("root", accuracy.getRoot());
+            accuracyResults.add(juce::var(entry));
+
+            std::cout << "  " << condition.name << " " << juce::String(accuracy.getExact() * 100.0, 1)
+                      << "% / " << juce::String(accuracy.getRoot() * 100.0, 1) << "%";
+        }
+
+        std::cout << std::endl;
+    }
+
+    std::cout << "  overall: " << juce::String(overall.getExact() * 100.0, 1) << "% exact, "
+              << juce::String(overall.getRoot() * 100.0, 1) << "% root" << std::endl;
+
+    results->setProperty("stages", stageResults);
+    results->setProperty("accuracy", accuracyResults);
+    results->setProperty("overallExact", overall.getExact());
+    results->setProperty("overallRoot", overall.getRoot());
+
+    const auto jsonOption = args.getValueForOption("--json");
+    if (jsonOption.isNotEmpty())
+    {
+        const auto jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile(jsonOption);
+        if (! jsonFile.replaceWithText(juce::JSON::toString(resultsVar)))
+            juce::ConsoleApplication::fail("Couldn't write " + jsonFile.getFullPathName());
+    }
+
+    // Lets a CI job catch accuracy regressions
+    const auto minAccuracy = args.getValueForOption("--min-accuracy");
+    if (minAccuracy.isNotEmpty() && overall.getExact() < minAccuracy.getDoubleValue())
+        juce::ConsoleApplication::fail("Exact accuracy " + juce::String(overall.getExact(), 3) + " is below " + minAccuracy, 2);
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    SyntheticChords.cpp
+
+  ==============================================================================
+*/
+
+#include "SyntheticChords.h"
+#include "../../Source/Analysis/ChordTemplates.h"
+#include <vector>
+
+namespace
+{
+    constexpr int chordOctaveBase = 48;     // C3: chord tones sit in the octave above this
+    constexpr int bassOctaveBase = 36;      // C2
+    constexpr float bassGain = 1.5f;
+
+    double midiToHz(double note)
+    {
+        return 440.0 * std::pow(2.0, (note - 69.0) / 12.0);
+    }
+}
+
+void renderSyntheticChord(int chordIndex, const SyntheticChordSettings& settings, juce::Random& random,
+                          juce::AudioBuffer<float>& dest, int destStart, int numSamples)
+{
+    jassert(juce::isPositiveAndBelow(chordIndex, ChordTemplates::numChords));
+    jassert(destStart + numSamples <= dest.getNumSamples());
+
+    struct Note { double pitch; float gain; };
+    std::vector<Note> notes;
+
+    const int root = ChordTemplates::getRoot(chordIndex);
+    const auto mask = ChordTemplates::chordTypes[ChordTemplates::getType(chordIndex)].intervalMask;
+
+    for (int interval = 0; interval < 12; ++interval)
+        if ((mask & (1 << interval)) != 0)
+            notes.push_back({ (double) (chordOctaveBase + root + interval), 1.0f });
+
+    // The bass note decides the inversion, so it is louder and below everything else
+    notes.push_back({ (double) (bassOctaveBase + ChordTemplates::getBassPitchClass(chordIndex)), bassGain });
+
+    auto* out = dest.getWritePointer(0, destStart);
+    juce::FloatVectorOperations::clear(out, numSamples);
+
+    const double nyquist = settings.sampleRate * 0.5;
+
+    for (auto& note : notes)
+    {
+        const double detune = (random.nextDouble() * 2.0 - 1.0) * settings.maxDetuneCents / 100.0;
+        const double fundamental = midiToHz(note.pitch + detune);
+
+        for (int partial = 1; partial <= settings.numPartials; ++partial)
+        {
+            const double freq = fundamental * partial;
+            if (freq >= nyquist)
+                break;
+
+            const double delta = juce::MathConstants<double>::twoPi * freq / settings.sampleRate;
+            const double phase = random.nextDouble() * juce::MathConstants<double>::twoPi;
+            const float gain = note.gain / (float) partial;
+
+            for (int i = 0; i < numSamples; ++i)
+                out[i] += gain * (float) std::sin(phase + delta * i);
+        }
+    }
+
+    // Normalise to a modest peak, then add noise relative to the signal level
+    const auto peak = juce::FloatVectorOperations::findMaximum(out, numSamples);
+    const auto trough = juce::FloatVectorOperations::findMinimum(out, numSamples);
+    const auto range = juce::jmax(peak, -trough);
+
+    if (range > 0.0f)
+        juce::FloatVectorOperations::multiply(out, 0.5f / range, numSamples);
+
+    if (settings.snrDb > 0.0f)
+    {
+        const auto signalRms = dest.getRMSLevel(0, destStart, numSamples);
+        const auto noiseRms = signalRms * std::pow(10.0f, -settings.snrDb / 20.0f);
+        const auto noiseGain = noiseRms * std::sqrt(3.0f);     // uniform noise in [-1, 1] has an RMS of 1/sqrt(3)
+
+        for (int i = 0; i < numSamples; ++i)
+            out[i] += noiseGain * (random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    for (int channel = 1; channel < dest.getNumChannels(); ++channel)
+        dest.copyFrom(channel, destStart, dest, 0, destStart, numSamples);
+}
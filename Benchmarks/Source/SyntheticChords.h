@@ -0,0 +1,29 @@
+/*
+  ==============================================================================
+
+    SyntheticChords.h
+
+    Test signals with known labels: every chord in the dictionary rendered as
+    a sum of harmonic partials, with a bass note an octave below for the
+    inversions, optional per-note detuning and white noise.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct SyntheticChordSettings
+{
+    double sampleRate = 44100.0;
+    int numPartials = 8;            // partial n has amplitude 1/n
+    float maxDetuneCents = 0.0f;    // each note is detuned by a random amount up to this
+    float snrDb = 0.0f;             // white noise at this signal-to-noise ratio; 0 for none
+};
+
+/** Renders the chord into every channel of dest, from destStart for numSamples.
+    Phases, detuning and noise come from random, so a fixed seed gives repeatable signals.
+*/
+void renderSyntheticChord(int chordIndex, const SyntheticChordSettings&, juce::Random& random,
+                          juce::AudioBuffer<float>& dest, int destStart, int numSamples);
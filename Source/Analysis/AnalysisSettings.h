@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    AnalysisSettings.h
+
+    STFT configuration shared by the offline and live analysis: FFT size,
+    how many samples of each frame are actually analysed (the rest is zero
+    padding), the hop between frames, which is chosen independently of
+    the frame size, how each frame's spectrum becomes a chroma vector,
+    whether the offline chord sequence is smoothed (see ChordSmoother), and
+    whether it is decided per frame or per beat.
+
+    With beatSync, the offline hop is half an onset frame, for the onset
+    envelope (see OnsetDetector). Chroma frames are taken back to back, one
+    frame size apart, and chords are matched once per tracked beat from the
+    chroma in between (see OfflineChordAnalysis). The beats are tracked at
+    tempoBpm if it is set (the host's tempo, say), or else at the tempo
+    estimated from the file.
+
+    Beat sync is for alignment, not speed. Chord boundaries fall on beats
+    and every sample is heard, at about the cost of the preset's half-frame
+    hop. That is several times the work of a 0.5 s hop, which skips most of
+    the audio.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct AnalysisSettings
+{
+    enum class Preset
+    {
+        standard = 1,       // 4096-point frames, as the analysis has always used
+        lowLatency,         // 1024-sample frames zero-padded to a 4096-point FFT
+        highResolution      // 16384-point frames, for offline work
+    };
+
+    enum class Chroma
+    {
+        peaks = 1,          // local maxima of the linear FFT spectrum (ChromaMapper)
+        constantQ           // sparse constant-Q kernel (ConstantQChroma)
+    };
+
+    // StftEngine is instantiated for every frame order from minOrder up to each FFT order in this range
+    static constexpr int minOrder = 10;
+    static constexpr int maxOrder = 14;
+
+    static constexpr double defaultHopSeconds = 0.5;
+    static constexpr int onsetFrameSize = 1024;
+
+    int fftOrder = 12;
+    int frameOrder = 12;                    // <= fftOrder
+    double hopSeconds = defaultHopSeconds;  // 0 or less means half a frame
+    Chroma chroma = Chroma::peaks;
+    bool smoothing = false;                 // offline analysis only
+    bool beatSync = false;                  // offline analysis only
+    double tempoBpm = 0.0;                  // with beatSync; 0 or less estimates it
+
+    static AnalysisSettings fromPreset(Preset preset)
+    {
+        switch (preset)
+        {
+            case Preset::lowLatency:        return { 12, 10, 0.1 };
+            case Preset::highResolution:    return { 14, 14, 0.25 };
+            case Preset::standard:          break;
+        }
+
+        return {};
+    }
+
+    static juce::StringArray getPresetNames()     { return { "Standard", "Low latency", "High resolution" }; }
+    static juce::StringArray getChromaNames()     { return { "Peaks", "Constant-Q" }; }
+
+    AnalysisSettings withHopSeconds(double newHopSeconds) const
+    {
+        auto s = *this;
+        s.hopSeconds = newHopSeconds;
+        return s;
+    }
+
+    AnalysisSettings withChroma(Chroma newChroma) const
+    {
+        auto s = *this;
+        s.chroma = newChroma;
+        return s;
+    }
+
+    AnalysisSettings withSmoothing(bool shouldSmooth) const
+    {
+        auto s = *this;
+        s.smoothing = shouldSmooth;
+        return s;
+    }
+
+    AnalysisSettings withBeatSync(bool shouldSyncToBeats, double newTempoBpm = 0.0) const
+    {
+        auto s = *this;
+        s.beatSync = shouldSyncToBeats;
+        s.tempoBpm = shouldSyncToBeats ? newTempoBpm : 0.0;
+        return s;
+    }
+
+    bool isValid() const noexcept
+    {
+        return fftOrder >= minOrder && fftOrder <= maxOrder && frameOrder >= minOrder && frameOrder <= fftOrder
+            && (chroma == Chroma::peaks || chroma == Chroma::constantQ);
+    }
+
+    int getFftSize() const noexcept                     { return 1 << fftOrder; }
+    int getFrameSize() const noexcept                   { return 1 << frameOrder; }
+
+    int getHopSize(double sampleRate) const noexcept
+    {
+        if (beatSync)
+            return onsetFrameSize / 2;
+
+        return hopSeconds > 0.0 ? juce::jmax(1, juce::roundToInt(hopSeconds * sampleRate)) : getFrameSize() / 2;
+    }
+
+    bool operator== (const AnalysisSettings& other) const noexcept
+    {
+        return fftOrder == other.fftOrder && frameOrder == other.frameOrder && hopSeconds == other.hopSeconds
+            && chroma == other.chroma && smoothing == other.smoothing
+            && beatSync == other.beatSync && tempoBpm == other.tempoBpm;
+    }
+
+    bool operator!= (const AnalysisSettings& other) const noexcept     { return ! operator== (other); }
+};
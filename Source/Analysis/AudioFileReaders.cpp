@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    AudioFileReaders.cpp
+
+  ==============================================================================
+*/
+
+#include "AudioFileReaders.h"
+
+namespace AudioFileReaders
+{
+    std::unique_ptr<juce::AudioFormatReader> createReaderFor(juce::AudioFormatManager& formatManager, const juce::File& file)
+    {
+        // Only WAV and AIFF implement createMemoryMappedReader; the others return nullptr
+        if (auto* format = formatManager.findFormatForFileExtension(file.getFileExtension()))
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+
+            // Mapping reserves address space but reads nothing. It can fail for
+            // files that don't fit the address space, or for sample formats the
+            // mapped readers can't convert, in which case fall back.
+            if (mapped != nullptr && mapped->lengthInSamples > 0 && mapped->mapEntireFile())
+                return mapped;
+        }
+
+        return std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(file));
+    }
+
+    bool isMemoryMapped(const juce::AudioFormatReader& reader)
+    {
+        return dynamic_cast<const juce::MemoryMappedAudioFormatReader*>(&reader) != nullptr;
+    }
+}
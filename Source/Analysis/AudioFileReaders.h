@@ -0,0 +1,29 @@
+/*
+  ==============================================================================
+
+    AudioFileReaders.h
+
+    Opens readers for imported files. Uncompressed WAV and AIFF files are
+    memory-mapped, so opening is just a header parse however large the file
+    is, and reads convert samples straight out of the mapped pages: only the
+    parts that are actually touched get paged in, and the OS can drop them
+    again under memory pressure. Everything else goes through the normal
+    streaming decoders.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace AudioFileReaders
+{
+    /** Returns a memory-mapped reader where the format supports it, otherwise
+        whatever formatManager.createReaderFor() gives, or nullptr.
+    */
+    std::unique_ptr<juce::AudioFormatReader> createReaderFor(juce::AudioFormatManager& formatManager, const juce::File& file);
+
+    /** True if the reader was opened as a memory-mapped reader. */
+    bool isMemoryMapped(const juce::AudioFormatReader& reader);
+}
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    BeatTracker.cpp
+
+  ==============================================================================
+*/
+
+#include "BeatTracker.h"
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    // Width of the tempo preference around preferredBpm, in octaves
+    constexpr double tempoSpreadOctaves = 1.4;
+
+    // Scaled to unit standard deviation, so the tightness means the same at any level
+    std::vector<float> normalise(const float* onsetStrength, int numFrames)
+    {
+        std::vector<float> envelope(onsetStrength, onsetStrength + numFrames);
+
+        double sum = 0.0, sumOfSquares = 0.0;
+        for (auto x : envelope)
+        {
+            sum += x;
+            sumOfSquares += (double) x * x;
+        }
+
+        const auto mean = sum / juce::jmax(1, numFrames);
+        const auto deviation = std::sqrt(juce::jmax(0.0, sumOfSquares / juce::jmax(1, numFrames) - mean * mean));
+
+        if (deviation > 0.0)
+            for (auto& x : envelope)
+                x = (float) (x / deviation);
+
+        return envelope;
+    }
+}
+
+double BeatTracker::estimateTempo(const float* onsetStrength, int numFrames, double framesPerSecond)
+{
+    const int minLag = juce::jmax(1, (int) std::floor(60.0 * framesPerSecond / maxBpm));
+    const int maxLag = (int) std::ceil(60.0 * framesPerSecond / minBpm);
+
+    if (numFrames <= maxLag + 1)
+        return preferredBpm;
+
+    // Only the fluctuations correlate usefully; the mean would favour the shortest lags
+    auto envelope = normalise(onsetStrength, numFrames);
+    const auto mean = std::accumulate(envelope.begin(), envelope.end(), 0.0) / numFrames;
+
+    for (auto& x : envelope)
+        x -= (float) mean;
+
+    const auto preferredLag = 60.0 * framesPerSecond / preferredBpm;
+    std::vector<double> weighted((size_t) maxLag + 2, 0.0);
+
+    for (int lag = minLag; lag <= maxLag + 1; ++lag)
+    {
+        double correlation = 0.0;
+
+        for (int i = lag; i < numFrames; ++i)
+            correlation += (double) envelope[(size_t) i] * envelope[(size_t) (i - lag)];
+
+        const auto octaves = std::log2((double) lag / preferredLag) / tempoSpreadOctaves;
+        weighted[(size_t) lag] = correlation / (numFrames - lag) * std::exp(-0.5 * octaves * octaves);
+    }
+
+    const auto best = (int) (std::max_element(weighted.begin() + minLag, weighted.begin() + maxLag + 1) - weighted.begin());
+
+    if (weighted[(size_t) best] <= 0.0)
+        return preferredBpm;
+
+    // A parabola through the peak and its neighbours puts it between frames
+    double lag = best;
+
+    if (best > minLag)
+    {
+        const auto before = weighted[(size_t) best - 1], peak = weighted[(size_t) best], after = weighted[(size_t) best + 1];
+        const auto curvature = before - 2.0 * peak + after;
+
+        if (curvature < 0.0)
+            lag += 0.5 * (before - after) / curvature;
+    }
+
+    return juce::jlimit(minBpm, maxBpm, 60.0 * framesPerSecond / lag);
+}
+
+std::vector<int> BeatTracker::trackBeats(const float* onsetStrength, int numFrames, double framesPerSecond,
+                                         double bpm, float tightness)
+{
+    if (numFrames <= 0 || framesPerSecond <= 0.0)
+        return {};
+
+    const auto period = 60.0 * framesPerSecond / juce::jlimit(minBpm, maxBpm, bpm);
+    const int nearest = juce::jmax(1, juce::roundToInt(period / 2.0));
+    const int furthest = juce::jmax(nearest, juce::roundToInt(period * 2.0));
+
+    const auto envelope = normalise(onsetStrength, numFrames);
+
+    // The penalty depends only on the gap, so it is tabulated once
+    std::vector<float> penalty((size_t) furthest + 1, 0.0f);
+    for (int gap = nearest; gap <= furthest; ++gap)
+    {
+        const auto ratio = std::log(gap / period);
+        penalty[(size_t) gap] = (float) (tightness * ratio * ratio);
+    }
+
+    std::vector<float> score((size_t) numFrames);
+    std::vector<int> previousBeat((size_t) numFrames, -1);
+
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        float bestEarlier = 0.0f;
+
+        for (int gap = nearest; gap <= juce::jmin(furthest, frame); ++gap)
+        {
+            const auto candidate = score[(size_t) (frame - gap)] - penalty[(size_t) gap];
+
+            if (previousBeat[(size_t) frame] < 0 || candidate > bestEarlier)
+            {
+                bestEarlier = candidate;
+                previousBeat[(size_t) frame] = frame - gap;
+            }
+        }
+
+        score[(size_t) frame] = envelope[(size_t) frame] + bestEarlier;
+    }
+
+    // The last beat is the best-scoring frame within a period of the end
+    const int searchFrom = juce::jmax(0, numFrames - juce::roundToInt(period));
+    int beat = (int) (std::max_element(score.begin() + searchFrom, score.end()) - score.begin());
+
+    std::vector<int> beats;
+    for (; beat >= 0; beat = previousBeat[(size_t) beat])
+        beats.push_back(beat);
+
+    std::reverse(beats.begin(), beats.end());
+    return beats;
+}
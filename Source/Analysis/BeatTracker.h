@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    BeatTracker.h
+
+    Tempo and beat positions from an onset strength envelope (see
+    OnsetDetector), after Ellis, "Beat Tracking by Dynamic Programming"
+    (2007).
+
+    The tempo is the lag at which the envelope best correlates with itself,
+    weighted towards 120 BPM on a log scale, so that a strong half- or
+    double-time lag doesn't win by a hair. The beats are then the sequence
+    that best balances landing on strong onsets against keeping that
+    tempo: each frame's best score as a beat is its own strength plus the
+    best earlier beat between half and twice a period back, less a penalty
+    that grows with the squared log ratio of the gap to the period. One pass
+    forward, one back along the stored predecessors.
+
+    Offline only: both allocate and look at the whole envelope.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+namespace BeatTracker
+{
+    constexpr double minBpm = 40.0;
+    constexpr double maxBpm = 240.0;
+    constexpr double preferredBpm = 120.0;
+
+    /** How strongly the beats keep to the tempo rather than following the onsets. */
+    constexpr float defaultTightness = 100.0f;
+
+    /** Returns the envelope's most likely tempo in BPM, or preferredBpm if it is
+        too short or silent to tell.
+
+        @param framesPerSecond  the envelope's rate, i.e. sample rate / hop
+    */
+    double estimateTempo(const float* onsetStrength, int numFrames, double framesPerSecond);
+
+    /** Returns the frames that carry a beat at the given tempo, in order. */
+    std::vector<int> trackBeats(const float* onsetStrength, int numFrames, double framesPerSecond,
+                                double bpm, float tightness = defaultTightness);
+}
@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    ChordAnalysisCache.cpp
+
+  ==============================================================================
+*/
+
+#include "ChordAnalysisCache.h"
+#include <algorithm>
+
+namespace
+{
+    // File layout, little-endian:
+    //   int32 magic, int32 version, double sampleRate, int32 stepSize, int32 numFrames,
+    //   then numFrames x (int64 position, int16 chordIndex, float score).
+    // Positions are stored because beat-synchronous frames aren't stepSize apart.
+    constexpr int magic = 0x41435356; // "VSCA"
+    constexpr int version = 2;
+    constexpr int frameBytes = 8 + 2 + 4;
+    const char* const fileSuffix = ".chords";
+
+    constexpr int numHashBlocks = 16;
+    constexpr int hashBlockSize = 64 * 1024;
+
+    juce::uint64 fnv1a(const void* data, size_t numBytes, juce::uint64 hash)
+    {
+        auto* bytes = static_cast<const juce::uint8*>(data);
+
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+
+        return hash;
+    }
+
+    juce::String createParameterKey(const juce::String& parameterSignature)
+    {
+        const auto hash = fnv1a(parameterSignature.toRawUTF8(), parameterSignature.getNumBytesAsUTF8(), 14695981039346656037ull);
+        return juce::String::toHexString((juce::int64) hash).paddedLeft('0', 16);
+    }
+}
+
+ChordAnalysisCache::ChordAnalysisCache(const juce::File& dir, juce::int64 maxSize)
+    : directory(dir), maxSizeBytes(maxSize)
+{
+}
+
+juce::File ChordAnalysisCache::getDefaultDirectory()
+{
+   #if JUCE_MAC
+    auto base = juce::File("~/Library/Caches");
+   #elif JUCE_WINDOWS
+    auto base = juce::File::getSpecialLocation(juce::File::windowsLocalAppData);
+   #else
+    auto xdgCache = juce::SystemStats::getEnvironmentVariable("XDG_CACHE_HOME", {});
+    auto base = xdgCache.isNotEmpty() && juce::File::isAbsolutePath(xdgCache) ? juce::File(xdgCache)
+                                                                              : juce::File("~/.cache");
+   #endif
+
+    return base.getChildFile("VST Sampler").getChildFile("ChordAnalysis");
+}
+
+juce::String ChordAnalysisCache::createKey(const juce::File& audioFile, const juce::String& parameterSignature)
+{
+    juce::FileInputStream stream(audioFile);
+
+    if (! stream.openedOk())
+        return {};
+
+    const auto fileSize = stream.getTotalLength();
+    auto hash = fnv1a(&fileSize, sizeof(fileSize), 14695981039346656037ull);
+
+    // Small files are hashed whole; large ones through evenly spaced blocks,
+    // always including the first and last so header and tail edits are seen.
+    juce::HeapBlock<char> block(hashBlockSize);
+    const int numBlocks = fileSize <= (juce::int64) numHashBlocks * hashBlockSize
+                            ? (int) ((fileSize + hashBlockSize - 1) / hashBlockSize)
+                            : numHashBlocks;
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        const auto position = numBlocks > 1 ? (fileSize - hashBlockSize) * i / (numBlocks - 1) : (juce::int64) 0;
+        stream.setPosition(juce::jmax((juce::int64) 0, position));
+
+        const int bytesRead = stream.read(block.getData(), hashBlockSize);
+        hash = fnv1a(block.getData(), (size_t) juce::jmax(0, bytesRead), hash);
+    }
+
+    return juce::String::toHexString((juce::int64) hash).paddedLeft('0', 16) + "-" + createParameterKey(parameterSignature);
+}
+
+juce::String ChordAnalysisCache::withParameters(const juce::String& key, const juce::String& parameterSignature)
+{
+    return key.upToFirstOccurrenceOf("-", false, false) + "-" + createParameterKey(parameterSignature);
+}
+
+bool ChordAnalysisCache::keyMatchesParameters(const juce::String& key, const juce::String& parameterSignature)
+{
+    return key.isNotEmpty() && key.endsWith("-" + createParameterKey(parameterSignature));
+}
+
+juce::File ChordAnalysisCache::getFileForKey(const juce::String& key) const
+{
+    return directory.getChildFile(key + fileSuffix);
+}
+
+bool ChordAnalysisCache::load(const juce::String& key, Entry& result) const
+{
+    if (key.isEmpty())
+        return false;
+
+    const juce::ScopedLock sl(lock);
+    const auto file = getFileForKey(key);
+
+    juce::FileInputStream stream(file);
+
+    if (! stream.openedOk() || stream.readInt() != magic || stream.readInt() != version)
+        return false;
+
+    Entry entry;
+    entry.sampleRate = stream.readDouble();
+    entry.stepSize = stream.readInt();
+    const int numFrames = stream.readInt();
+
+    if (numFrames < 0 || entry.stepSize <= 0 || stream.getTotalLength() - stream.getPosition() < (juce::int64) numFrames * frameBytes)
+        return false;
+
+    entry.frames.resize((size_t) numFrames);
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        auto& frame = entry.frames[(size_t) i];
+        frame.position = stream.readInt64();
+        frame.chordIndex = stream.readShort();
+        frame.score = stream.readFloat();
+    }
+
+    // Mark as recently used
+    file.setLastModificationTime(juce::Time::getCurrentTime());
+
+    result = std::move(entry);
+    return true;
+}
+
+bool ChordAnalysisCache::store(const juce::String& key, const Entry& entry)
+{
+    if (key.isEmpty())
+        return false;
+
+    const juce::ScopedLock sl(lock);
+
+    if (directory.createDirectory().failed())
+        return false;
+
+    // Write to a temporary file and move it into place, so a reader never sees half an entry
+    juce::TemporaryFile temp(getFileForKey(key));
+
+    {
+        juce::FileOutputStream stream(temp.getFile());
+
+        if (! stream.openedOk())
+            return false;
+
+        stream.writeInt(magic);
+        stream.writeInt(version);
+        stream.writeDouble(entry.sampleRate);
+        stream.writeInt(entry.stepSize);
+        stream.writeInt((int) entry.frames.size());
+
+        for (const auto& frame : entry.frames)
+        {
+            stream.writeInt64(frame.position);
+            stream.writeShort((short) frame.chordIndex);
+            stream.writeFloat(frame.score);
+        }
+
+        stream.flush();
+
+        if (stream.getStatus().failed())
+            return false;
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return false;
+
+    evictLeastRecentlyUsed();
+    return true;
+}
+
+ChordAnalysisCache::Entry ChordAnalysisCache::createEntry(const OfflineChordAnalysis& analysis)
+{
+    Entry entry;
+    entry.sampleRate = analysis.getSampleRate();
+    entry.stepSize = analysis.getStepSize();
+
+    const int numFrames = analysis.getNumFramesReady();
+    entry.frames.reserve((size_t) numFrames);
+
+    for (int i = 0; i < numFrames; ++i)
+        entry.frames.push_back(analysis.getFrame(i));
+
+    return entry;
+}
+
+void ChordAnalysisCache::evictLeastRecentlyUsed()
+{
+    auto files = directory.findChildFiles(juce::File::findFiles, false, juce::String("*") + fileSuffix);
+
+    juce::int64 totalSize = 0;
+    for (auto& f : files)
+        totalSize += f.getSize();
+
+    if (totalSize <= maxSizeBytes)
+        return;
+
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    for (auto& f : files)
+    {
+        if (totalSize <= maxSizeBytes)
+            break;
+
+        const auto size = f.getSize();
+        if (f.deleteFile())
+            totalSize -= size;
+    }
+}
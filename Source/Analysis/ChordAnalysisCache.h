@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    ChordAnalysisCache.h
+
+    On-disk cache of finished offline analyses, so re-importing a file (or
+    reopening a session) doesn't repeat the FFT pass.
+
+    Entries are keyed by a sampled hash of the file's content plus the
+    analysis parameter signature, and stored one small binary file each in the
+    user cache directory. The total size is bounded: the least recently used
+    entries are evicted first, using the files' modification times, which are
+    refreshed on every hit.
+
+    Safe to use from several threads at once.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OfflineChordAnalysis.h"
+
+class ChordAnalysisCache
+{
+public:
+    struct Entry
+    {
+        double sampleRate = 0.0;
+        int stepSize = 0;
+        std::vector<OfflineChordAnalysis::Frame> frames;
+    };
+
+    static constexpr juce::int64 defaultMaxSizeBytes = 64 * 1024 * 1024;
+
+    explicit ChordAnalysisCache(const juce::File& directory = getDefaultDirectory(),
+                                juce::int64 maxSizeBytes = defaultMaxSizeBytes);
+
+    /** The platform's per-user cache location, e.g. ~/.cache/VST Sampler. */
+    static juce::File getDefaultDirectory();
+
+    /** Hashes the file's size and a spread of blocks from its content, so
+        even multi-gigabyte files are keyed in a few milliseconds. Returns an
+        empty string if the file can't be read.
+    */
+    static juce::String createKey(const juce::File& audioFile, const juce::String& parameterSignature);
+
+    /** True if a key was created with this parameter signature, i.e. it is
+        still valid for the current analysis settings.
+    */
+    static bool keyMatchesParameters(const juce::String& key, const juce::String& parameterSignature);
+
+    /** The same file's key under different parameters, without rehashing the file. */
+    static juce::String withParameters(const juce::String& key, const juce::String& parameterSignature);
+
+    /** Returns true and fills result on a hit. */
+    bool load(const juce::String& key, Entry& result) const;
+
+    /** Writes an entry (replacing any existing one), then evicts old entries if over budget. */
+    bool store(const juce::String& key, const Entry& entry);
+
+    /** Builds an entry from a finished analysis. */
+    static Entry createEntry(const OfflineChordAnalysis& analysis);
+
+private:
+    juce::File getFileForKey(const juce::String& key) const;
+    void evictLeastRecentlyUsed();
+
+    const juce::File directory;
+    const juce::int64 maxSizeBytes;
+    juce::CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChordAnalysisCache)
+};
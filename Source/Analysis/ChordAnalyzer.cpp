@@ -0,0 +1,31 @@
+/*
+  ==============================================================================
+
+    ChordAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "ChordAnalyzer.h"
+
+void ChordAnalyzer::prepare(double newSampleRate, const AnalysisSettings& settings)
+{
+    jassert(settings.isValid());
+
+    if (engine == nullptr || engine->getFftOrder() != settings.fftOrder || engine->getFrameOrder() != settings.frameOrder)
+        engine = StftEngineBase::create(settings.fftOrder, settings.frameOrder);
+
+    if (engine == nullptr)
+        engine = StftEngineBase::create(defaultFftOrder, defaultFftOrder);
+
+    sampleRate = newSampleRate;
+    engine->prepare(sampleRate, settings.chroma);
+}
+
+void ChordAnalyzer::prepare(double newSampleRate, int fftOrder)
+{
+    AnalysisSettings settings;
+    settings.fftOrder = fftOrder;
+    settings.frameOrder = fftOrder;
+    prepare(newSampleRate, settings);
+}
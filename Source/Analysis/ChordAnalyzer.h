@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    ChordAnalyzer.h
+
+    One STFT frame -> chord, with everything it needs allocated up front.
+    prepare() picks the StftEngine instantiation for the FFT and frame size
+    and builds its chroma tables; analyseFrame() then does no heap
+    allocation at all, so an analyzer can be kept alive and reused for every
+    frame of a file or a live stream.
+
+    An analyzer is not thread-safe: give each thread its own.
+
+    (JUCE's fallback FFT engine uses alloca for its scratch space up to
+    order 14 and the heap above that, which is why AnalysisSettings stops at
+    order 14.)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalysisSettings.h"
+#include "StftEngine.h"
+
+class ChordAnalyzer
+{
+public:
+    static constexpr int defaultFftOrder = 12;
+
+    using Result = StftEngineBase::Result;
+
+    ChordAnalyzer() = default;
+
+    /** Allocates everything for the given configuration. Does nothing if it hasn't changed.
+        The settings' hop is ignored: the caller decides where frames start.
+    */
+    void prepare(double sampleRate, const AnalysisSettings& settings);
+
+    /** Unpadded frames of 2^fftOrder samples. */
+    void prepare(double sampleRate, int fftOrder = defaultFftOrder);
+
+    bool isPrepared() const noexcept            { return engine != nullptr; }
+    double getSampleRate() const noexcept       { return sampleRate; }
+    int getFftOrder() const noexcept            { return engine != nullptr ? engine->getFftOrder() : 0; }
+    int getFftSize() const noexcept             { return 1 << getFftOrder(); }
+
+    /** Samples analysed per frame; the FFT zero-pads them up to getFftSize(). */
+    int getFrameSize() const noexcept           { return engine != nullptr ? 1 << engine->getFrameOrder() : 0; }
+
+    /** Sums getFrameSize() samples from each channel, applies the window, and
+        runs the FFT, PCP (peak picking or constant-Q) and template match.
+        Allocation-free.
+    */
+    Result analyseFrame(const float* const* channels, int numChannels) noexcept
+    {
+        jassert(isPrepared());
+        return engine->analyseFrame(channels, numChannels);
+    }
+
+    /** As analyseFrame(), but stops at the pitch class profile, for callers that
+        match chords over several frames at once. Allocation-free.
+    */
+    void computePitchClassProfile(const float* const* channels, int numChannels) noexcept
+    {
+        jassert(isPrepared());
+        engine->computePitchClassProfile(channels, numChannels);
+    }
+
+    /** The last frame's magnitude spectrum (getFftSize() / 2 bins). Only filled
+        with AnalysisSettings::Chroma::peaks; the constant-Q path keeps the complex spectrum.
+    */
+    const float* getMagnitudes() const noexcept { return engine->getMagnitudes(); }
+    int getNumBins() const noexcept             { return getFftSize() / 2; }
+
+    /** The last frame's 12-bin pitch class profile. */
+    const float* getPitchClassProfile() const noexcept { return engine->getPitchClassProfile(); }
+
+private:
+    double sampleRate = 0.0;
+    std::unique_ptr<StftEngineBase> engine;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChordAnalyzer)
+};
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    ChordDetection.cpp
+
+  ==============================================================================
+*/
+
+#include "ChordDetection.h"
+#include "ChordTemplates.h"
+
+namespace ChordDetection
+{
+    namespace
+    {
+        const char* const noteNames[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+    }
+
+    int getNumChords()
+    {
+        return ChordTemplates::numChords;
+    }
+
+    juce::String getChordName(int chordIndex)
+    {
+        if (chordIndex < 0 || chordIndex >= getNumChords())
+            return {};
+
+        const auto& type = ChordTemplates::chordTypes[ChordTemplates::getType(chordIndex)];
+        auto name = juce::String(noteNames[ChordTemplates::getRoot(chordIndex)]) + " " + type.name;
+
+        if (type.bassInterval != 0)
+            name += juce::String("/") + noteNames[ChordTemplates::getBassPitchClass(chordIndex)];
+
+        return name;
+    }
+
+    bool scoreChords(const float* pitchClassProfile, float* scores) noexcept
+    {
+        constexpr int numChords = ChordTemplates::numChords;
+
+        float sumOfSquares = 0.0f;
+        for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+            sumOfSquares += pitchClassProfile[pitchClass] * pitchClassProfile[pitchClass];
+
+        juce::FloatVectorOperations::clear(scores, numChords);
+
+        if (sumOfSquares <= 0.0f)
+            return false;
+
+        const float scale = 1.0f / std::sqrt(sumOfSquares);
+
+        // One column of the matrix-vector product per pitch class
+        for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+            if (pitchClassProfile[pitchClass] != 0.0f)
+                juce::FloatVectorOperations::addWithMultiply(scores, ChordTemplates::weights.data() + pitchClass * numChords,
+                                                             pitchClassProfile[pitchClass] * scale, numChords);
+
+        return true;
+    }
+
+    int matchChord(const float* pitchClassProfile, float* bestScoreOut) noexcept
+    {
+        float scores[ChordTemplates::numChords];
+
+        int bestChord = -1;
+        float bestScore = 0.0f;
+
+        // Compare PCP and chord templates and find the best match
+        if (scoreChords(pitchClassProfile, scores))
+        {
+            for (int chord = 0; chord < ChordTemplates::numChords; ++chord)
+            {
+                if (scores[chord] > bestScore)
+                {
+                    bestScore = scores[chord];
+                    bestChord = chord;
+                }
+            }
+        }
+
+        if (bestScoreOut != nullptr)
+            *bestScoreOut = bestScore;
+
+        return bestChord;
+    }
+}
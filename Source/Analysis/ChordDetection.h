@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    ChordDetection.h
+
+    PCP based chord matching shared by the offline "Chord ID" pass and the
+    live detector. Nothing in here depends on the editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ChordDetection
+{
+    /** Number of chord candidates (12 roots x the template set). */
+    int getNumChords();
+
+    /** Returns a display name such as "C# Minor" or "C Major/E", or an empty string for -1. */
+    juce::String getChordName(int chordIndex);
+
+    /** Scores a 12-bin pitch class profile (see ChromaMapper) against every chord template.
+        The profile is normalised first, so each score is a cosine similarity in [0, 1].
+
+        @param pitchClassProfile    12 values, C first
+        @param scores               getNumChords() floats, indexed by chord
+        @returns                    false if the profile was silent, in which case scores are all 0
+    */
+    bool scoreChords(const float* pitchClassProfile, float* scores) noexcept;
+
+    /** Scores a profile against the templates and returns the winner.
+
+        @param pitchClassProfile    12 values, C first
+        @param bestScore            if not null, receives the score of the winning template
+        @returns                    the index of the best chord, or -1 if nothing scored
+    */
+    int matchChord(const float* pitchClassProfile, float* bestScore = nullptr) noexcept;
+}
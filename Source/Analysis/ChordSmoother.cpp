@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    ChordSmoother.cpp
+
+  ==============================================================================
+*/
+
+#include "ChordSmoother.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    constexpr int numChords = ChordSmoother::numChords;
+    constexpr int numChordTypes = ChordTemplates::numChordTypes;
+
+    int findBestChord(const float* pathScores) noexcept
+    {
+        return (int) (std::max_element(pathScores, pathScores + numChords) - pathScores);
+    }
+
+    bool isSilent(const float* scores) noexcept
+    {
+        return juce::FloatVectorOperations::findMaximum(scores, numChords) <= 0.0f;
+    }
+
+    /** One Viterbi step: next[j] = emission[j] + max over i of (previous[i] + transition(i, j)),
+        with the winning i written to back[j].
+    */
+    void advance(const float* previous, const float* scores, float* next, juce::uint16* back,
+                 const ChordSmoother::Parameters& parameters) noexcept
+    {
+        // The best chord of each root to change from
+        float rootBest[12];
+        int rootBestChord[12];
+
+        for (int root = 0; root < 12; ++root)
+        {
+            const float* row = previous + root * numChordTypes;
+            const int best = (int) (std::max_element(row, row + numChordTypes) - row);
+            rootBest[root] = row[best];
+            rootBestChord[root] = root * numChordTypes + best;
+        }
+
+        // The best change into each root; the cost only depends on the interval
+        float changeCost[12];
+        for (int interval = 0; interval < 12; ++interval)
+            changeCost[interval] = parameters.changePenalty + parameters.rootMotionPenalty[(size_t) interval];
+
+        float changeBest[12];
+        int changeBestChord[12];
+
+        for (int to = 0; to < 12; ++to)
+        {
+            changeBest[to] = -std::numeric_limits<float>::max();
+            changeBestChord[to] = 0;
+
+            for (int from = 0; from < 12; ++from)
+            {
+                const float value = rootBest[from] - changeCost[(to - from + 12) % 12];
+
+                if (value > changeBest[to])
+                {
+                    changeBest[to] = value;
+                    changeBestChord[to] = rootBestChord[from];
+                }
+            }
+        }
+
+        // Each chord either stays, or takes the best change into its root
+        float largest = -std::numeric_limits<float>::max();
+
+        for (int root = 0; root < 12; ++root)
+        {
+            for (int chord = root * numChordTypes; chord < (root + 1) * numChordTypes; ++chord)
+            {
+                const bool change = changeBest[root] > previous[chord];
+                const float value = (change ? changeBest[root] : previous[chord]) + parameters.emissionScale * scores[chord];
+
+                next[chord] = value;
+                back[chord] = (juce::uint16) (change ? changeBestChord[root] : chord);
+                largest = juce::jmax(largest, value);
+            }
+        }
+
+        // Only differences matter; keep the values near zero so they don't lose precision over an hour
+        juce::FloatVectorOperations::add(next, -largest, numChords);
+    }
+}
+
+//==============================================================================
+void ChordSmoother::prepare(int lagFrames)
+{
+    prepare(lagFrames, Parameters());
+}
+
+void ChordSmoother::prepare(int lagFrames, const Parameters& newParameters)
+{
+    static_assert(numChords <= 65536, "Back-pointers are 16 bits");
+
+    parameters = newParameters;
+    lag = juce::jmax(0, lagFrames);
+
+    const auto numRows = (size_t) (lag + 1);
+    backPointers.assign(numRows * numChords, 0);
+    scoreRows.assign(numRows * numChords, 0.0f);
+    silentRows.assign(numRows, true);
+    pathScores.assign(numChords, 0.0f);
+    nextPathScores.assign(numChords, 0.0f);
+
+    reset();
+}
+
+void ChordSmoother::reset() noexcept
+{
+    numPushed = 0;
+    numDecided = 0;
+}
+
+bool ChordSmoother::push(const float* scores, Decision& decision) noexcept
+{
+    jassert(! pathScores.empty());  // call prepare() first
+
+    const int slot = getSlot(numPushed);
+    float* row = scoreRows.data() + (size_t) slot * numChords;
+
+    silentRows[(size_t) slot] = scores == nullptr;
+
+    if (scores != nullptr)
+        juce::FloatVectorOperations::copy(row, scores, numChords);
+    else
+        juce::FloatVectorOperations::clear(row, numChords);
+
+    if (numPushed == 0)
+    {
+        juce::FloatVectorOperations::copyWithMultiply(pathScores.data(), row, parameters.emissionScale, numChords);
+    }
+    else
+    {
+        advance(pathScores.data(), row, nextPathScores.data(), backPointers.data() + (size_t) slot * numChords, parameters);
+        std::swap(pathScores, nextPathScores);
+    }
+
+    ++numPushed;
+
+    if (getNumPending() <= lag)
+        return false;
+
+    decision = makeDecision(numDecided, backtrack(numPushed - 1, numDecided));
+    ++numDecided;
+    return true;
+}
+
+int ChordSmoother::flush(Decision* decisions) noexcept
+{
+    const int numPending = getNumPending();
+    int chord = findBestChord(pathScores.data());
+
+    for (int frame = numPushed - 1; frame >= numDecided; --frame)
+    {
+        decisions[frame - numDecided] = makeDecision(frame, chord);
+        chord = backPointers[(size_t) getSlot(frame) * numChords + (size_t) chord];
+    }
+
+    reset();
+    return numPending;
+}
+
+int ChordSmoother::backtrack(int fromFrame, int toFrame) const noexcept
+{
+    int chord = findBestChord(pathScores.data());
+
+    // Row f holds the way into frame f from frame f - 1
+    for (int frame = fromFrame; frame > toFrame; --frame)
+        chord = backPointers[(size_t) getSlot(frame) * numChords + (size_t) chord];
+
+    return chord;
+}
+
+ChordSmoother::Decision ChordSmoother::makeDecision(int frame, int chord) const noexcept
+{
+    const int slot = getSlot(frame);
+
+    if (silentRows[(size_t) slot])
+        return {};
+
+    return { chord, scoreRows[(size_t) slot * numChords + (size_t) chord] };
+}
+
+//==============================================================================
+void ChordSmoother::decode(const float* scores, int numFrames, int* path)
+{
+    decode(scores, numFrames, path, Parameters());
+}
+
+void ChordSmoother::decode(const float* scores, int numFrames, int* path, const Parameters& parameters)
+{
+    if (numFrames <= 0)
+        return;
+
+    std::vector<juce::uint16> back((size_t) numFrames * numChords);
+    std::vector<float> current(numChords), next(numChords);
+
+    juce::FloatVectorOperations::copyWithMultiply(current.data(), scores, parameters.emissionScale, numChords);
+
+    for (int frame = 1; frame < numFrames; ++frame)
+    {
+        const auto offset = (size_t) frame * numChords;
+        advance(current.data(), scores + offset, next.data(), back.data() + offset, parameters);
+        std::swap(current, next);
+    }
+
+    int chord = findBestChord(current.data());
+
+    for (int frame = numFrames - 1; frame >= 0; --frame)
+    {
+        const auto offset = (size_t) frame * numChords;
+        path[frame] = isSilent(scores + offset) ? -1 : chord;
+        chord = back[offset + (size_t) chord];
+    }
+}
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    ChordSmoother.h
+
+    Viterbi decoding of the chord sequence, so that a frame's chord depends
+    on its neighbours instead of flickering between close templates.
+
+    The hidden states are the chords of the dictionary, a frame's template
+    scores (scaled) are its log-likelihoods, and a transition costs nothing
+    if the chord stays, or a change penalty plus a root-motion penalty if it
+    doesn't. As the change cost only depends on the interval between the two
+    roots, the best way into every chord is found from 12 per-root maxima
+    rather than from all K chords, so a frame costs O(K + 12 x 12) instead of
+    O(K^2).
+
+    Scores and back-pointers are flat arrays, a row of K per frame. decode()
+    runs the exact algorithm over a whole sequence; push() runs it online
+    with a fixed lag, deciding each frame once lagFrames more have been seen,
+    with memory and latency bounded by the lag.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChordTemplates.h"
+#include <array>
+#include <vector>
+
+class ChordSmoother
+{
+public:
+    static constexpr int numChords = ChordTemplates::numChords;
+    static constexpr int defaultLagFrames = 16;
+
+    struct Parameters
+    {
+        float emissionScale = 20.0f;    // template score -> log-likelihood
+        float changePenalty = 3.0f;     // log-probability cost of any chord change
+
+        // Added to the change penalty by the interval between the roots, in semitones up:
+        // changes of quality on the same root and moves by a fourth or fifth are cheapest
+        std::array<float, 12> rootMotionPenalty { 0.0f, 1.0f, 0.5f, 0.5f, 0.5f, 0.25f, 1.0f, 0.25f, 0.5f, 0.5f, 0.5f, 1.0f };
+    };
+
+    struct Decision
+    {
+        int chordIndex = -1;    // -1 for a silent frame
+        float score = 0.0f;     // that chord's template score in this frame
+    };
+
+    ChordSmoother() = default;
+
+    /** Allocates everything for online decoding. */
+    void prepare(int lagFrames);
+    void prepare(int lagFrames, const Parameters&);
+
+    /** Forgets all frames pushed so far. */
+    void reset() noexcept;
+
+    /** Adds a frame. Allocation-free.
+
+        @param scores   numChords template scores from ChordDetection::scoreChords,
+                        or nullptr if the frame was silent
+        @param decision receives the chord of the frame pushed lagFrames earlier
+        @returns        false until more than lagFrames frames have been pushed
+    */
+    bool push(const float* scores, Decision& decision) noexcept;
+
+    /** Decides every frame still waiting for its lag, oldest first, then resets.
+
+        @param decisions    room for getNumPending() decisions
+        @returns            the number written
+    */
+    int flush(Decision* decisions) noexcept;
+
+    int getLagFrames() const noexcept       { return lag; }
+    int getNumPending() const noexcept      { return numPushed - numDecided; }
+
+    /** Exact Viterbi over a whole sequence. Allocates numFrames x numChords
+        back-pointers (2 bytes each).
+
+        @param scores   numFrames rows of numChords template scores; an all-zero row is a silent frame
+        @param path     receives numFrames chord indices, -1 for silent frames
+    */
+    static void decode(const float* scores, int numFrames, int* path);
+    static void decode(const float* scores, int numFrames, int* path, const Parameters&);
+
+private:
+    int getSlot(int frame) const noexcept   { return frame % (lag + 1); }
+    int backtrack(int fromFrame, int toFrame) const noexcept;
+    Decision makeDecision(int frame, int chord) const noexcept;
+
+    Parameters parameters;
+    int lag = 0, numPushed = 0, numDecided = 0;
+
+    // lag + 1 rows each, indexed by getSlot()
+    std::vector<juce::uint16> backPointers;
+    std::vector<float> scoreRows;
+    std::vector<bool> silentRows;
+
+    std::vector<float> pathScores, nextPathScores;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChordSmoother)
+};
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    ChordTemplates.h
+
+    The chord dictionary, built entirely at compile time. Every chord type is a
+    12-bit interval mask plus the interval that sits in the bass, and every
+    (root, type) pair becomes one unit-length row of template weights.
+
+    The weights are stored pitch-class major (12 rows of numChords floats), so
+    scoring a PCP against the whole dictionary is 12 vectorised multiply-adds
+    over contiguous memory.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <initializer_list>
+
+namespace ChordTemplates
+{
+    struct ChordType
+    {
+        const char* name;
+        juce::uint16 intervalMask;  // bit n set = the note n semitones above the root is in the chord
+        int bassInterval;           // 0 for root position, otherwise the inverted bass note
+    };
+
+    constexpr juce::uint16 intervals(std::initializer_list<int> semitones)
+    {
+        juce::uint16 mask = 0;
+        for (auto s : semitones)
+            mask = (juce::uint16) (mask | (1 << s));
+        return mask;
+    }
+
+    // Chord index = root * numChordTypes + type, so keep the order stable
+    // once anything has been stored with these indices.
+    inline constexpr ChordType chordTypes[] =
+    {
+        { "Major",                intervals({ 0, 4, 7 }),          0 },
+        { "Minor",                intervals({ 0, 3, 7 }),          0 },
+        { "Major 7th",            intervals({ 0, 4, 7, 11 }),      0 },
+        { "7th",                  intervals({ 0, 4, 7, 10 }),      0 },
+        { "Minor 7th",            intervals({ 0, 3, 7, 10 }),      0 },
+        { "Diminished",           intervals({ 0, 3, 6 }),          0 },
+        { "Augmented",            intervals({ 0, 4, 8 }),          0 },
+        { "Sus2",                 intervals({ 0, 2, 7 }),          0 },
+        { "Sus4",                 intervals({ 0, 5, 7 }),          0 },
+        { "6th",                  intervals({ 0, 4, 7, 9 }),       0 },
+        { "Minor 6th",            intervals({ 0, 3, 7, 9 }),       0 },
+        { "Minor Major 7th",      intervals({ 0, 3, 7, 11 }),      0 },
+        { "Diminished 7th",       intervals({ 0, 3, 6, 9 }),       0 },
+        { "Half-Diminished 7th",  intervals({ 0, 3, 6, 10 }),      0 },
+        { "7th Sus4",             intervals({ 0, 5, 7, 10 }),      0 },
+        { "Add9",                 intervals({ 0, 2, 4, 7 }),       0 },
+        { "9th",                  intervals({ 0, 2, 4, 7, 10 }),   0 },
+        { "Major 9th",            intervals({ 0, 2, 4, 7, 11 }),   0 },
+        { "Minor 9th",            intervals({ 0, 2, 3, 7, 10 }),   0 },
+
+        // Inversions, named as slash chords
+        { "Major",                intervals({ 0, 4, 7 }),          4 },
+        { "Major",                intervals({ 0, 4, 7 }),          7 },
+        { "Minor",                intervals({ 0, 3, 7 }),          3 },
+        { "Minor",                intervals({ 0, 3, 7 }),          7 },
+        { "7th",                  intervals({ 0, 4, 7, 10 }),      4 },
+        { "7th",                  intervals({ 0, 4, 7, 10 }),      7 },
+        { "7th",                  intervals({ 0, 4, 7, 10 }),      10 },
+        { "Major 7th",            intervals({ 0, 4, 7, 11 }),      4 },
+        { "Minor 7th",            intervals({ 0, 3, 7, 10 }),      3 }
+    };
+
+    constexpr int numChordTypes = (int) (sizeof(chordTypes) / sizeof(chordTypes[0]));
+    constexpr int numChords = 12 * numChordTypes;
+
+    // How much more the bass note counts than the other chord tones. A PCP
+    // carries no octave information, so this is what lets a strong bass pick
+    // out an inversion; with equal energy the root position still wins.
+    constexpr float bassWeight = 1.25f;
+
+    constexpr int getRoot(int chordIndex)           { return chordIndex / numChordTypes; }
+    constexpr int getType(int chordIndex)           { return chordIndex % numChordTypes; }
+    constexpr int getBassPitchClass(int chordIndex) { return (getRoot(chordIndex) + chordTypes[getType(chordIndex)].bassInterval) % 12; }
+
+    /** The chord's notes as a 12-bit pitch class mask, C = bit 0. */
+    constexpr juce::uint16 getPitchClassMask(int chordIndex)
+    {
+        const int root = getRoot(chordIndex);
+        const int mask = chordTypes[getType(chordIndex)].intervalMask;
+        return (juce::uint16) (((mask << root) | (mask >> (12 - root))) & 0xfff);
+    }
+
+    /** Changes whenever the dictionary does, so cached results can be invalidated. */
+    constexpr juce::uint32 getDictionaryHash()
+    {
+        juce::uint32 hash = 2166136261u;
+
+        for (const auto& type : chordTypes)
+        {
+            hash = (hash ^ type.intervalMask) * 16777619u;
+            hash = (hash ^ (juce::uint32) type.bassInterval) * 16777619u;
+        }
+
+        return (hash ^ (juce::uint32) (bassWeight * 1000.0f)) * 16777619u;
+    }
+
+    namespace detail
+    {
+        constexpr float squareRoot(float x)
+        {
+            float r = x > 1.0f ? x : 1.0f;
+            for (int i = 0; i < 24; ++i)
+                r = 0.5f * (r + x / r);
+            return r;
+        }
+
+        constexpr std::array<float, 12 * numChords> makeWeights()
+        {
+            std::array<float, 12 * numChords> weights {};
+
+            for (int chord = 0; chord < numChords; ++chord)
+            {
+                const auto& type = chordTypes[getType(chord)];
+
+                float sumOfSquares = 0.0f;
+                for (int interval = 0; interval < 12; ++interval)
+                    if ((type.intervalMask >> interval) & 1)
+                        sumOfSquares += interval == type.bassInterval ? bassWeight * bassWeight : 1.0f;
+
+                const float norm = squareRoot(sumOfSquares);
+
+                for (int interval = 0; interval < 12; ++interval)
+                {
+                    if ((type.intervalMask >> interval) & 1)
+                    {
+                        const int pitchClass = (getRoot(chord) + interval) % 12;
+                        weights[(size_t) (pitchClass * numChords + chord)] = (interval == type.bassInterval ? bassWeight : 1.0f) / norm;
+                    }
+                }
+            }
+
+            return weights;
+        }
+    }
+
+    /** weights[pitchClass * numChords + chordIndex] */
+    inline constexpr std::array<float, 12 * numChords> weights = detail::makeWeights();
+}
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    ChordTimeline.cpp
+
+  ==============================================================================
+*/
+
+#include "ChordTimeline.h"
+#include <algorithm>
+
+ChordTimeline::Builder::Builder(double sampleRate)
+    : timeline(new ChordTimeline(sampleRate))
+{
+}
+
+void ChordTimeline::Builder::addFrame(juce::int64 position, int chordIndex, float score)
+{
+    jassert(timeline != nullptr);   // build() has already been called
+    jassert(timeline->startSamples.empty() || position > timeline->startSamples.back());
+
+    if (runLength > 0 && timeline->chords.back() == chordIndex)
+    {
+        scoreSum += score;
+        ++runLength;
+        return;
+    }
+
+    finishRun();
+    timeline->startSamples.push_back(position);
+    timeline->chords.push_back((juce::int16) chordIndex);
+    timeline->confidences.push_back(0.0f);
+    scoreSum = score;
+    runLength = 1;
+}
+
+void ChordTimeline::Builder::finishRun()
+{
+    if (runLength > 0)
+        timeline->confidences.back() = (float) (scoreSum / runLength);
+}
+
+std::unique_ptr<ChordTimeline> ChordTimeline::Builder::build()
+{
+    finishRun();
+    runLength = 0;
+
+    timeline->startSamples.shrink_to_fit();
+    timeline->chords.shrink_to_fit();
+    timeline->confidences.shrink_to_fit();
+
+    return std::move(timeline);
+}
+
+//==============================================================================
+ChordTimeline::Segment ChordTimeline::getSegment(int index) const noexcept
+{
+    jassert(juce::isPositiveAndBelow(index, getNumSegments()));
+    return { startSamples[(size_t) index], chords[(size_t) index], confidences[(size_t) index] };
+}
+
+int ChordTimeline::getSegmentIndexAt(juce::int64 sample) const noexcept
+{
+    // The first start after the sample; the segment we're in is the one before it
+    const auto next = std::upper_bound(startSamples.begin(), startSamples.end(), sample);
+    return (int) (next - startSamples.begin()) - 1;
+}
+
+int ChordTimeline::getChordAt(double timeInSeconds) const noexcept
+{
+    const auto index = getSegmentIndexAt((juce::int64) (timeInSeconds * sampleRate));
+    return index >= 0 ? chords[(size_t) index] : -1;
+}
+
+int ChordTimeline::getLastChordIndex() const noexcept
+{
+    for (auto chord = chords.rbegin(); chord != chords.rend(); ++chord)
+        if (*chord >= 0)
+            return *chord;
+
+    return -1;
+}
+
+size_t ChordTimeline::getMemoryUsage() const noexcept
+{
+    return sizeof(ChordTimeline)
+         + startSamples.capacity() * sizeof(juce::int64)
+         + chords.capacity() * sizeof(juce::int16)
+         + confidences.capacity() * sizeof(float);
+}
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    ChordTimeline.h
+
+    The chords of a whole file as an immutable, sorted list of segments, one
+    per chord change: consecutive frames with the same chord are merged into
+    a single run. The segments are stored as parallel arrays (start sample,
+    chord, confidence), so an hour of audio takes a few kilobytes and the
+    chord at any position is found with a binary search over the starts.
+
+    A timeline is built once with a Builder and never modified afterwards,
+    so it can be handed between threads through a Mailbox without locking.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class ChordTimeline
+{
+public:
+    struct Segment
+    {
+        juce::int64 startSample = 0;
+        int chordIndex = -1;        // -1 where no chord was detected
+        float confidence = 0.0f;    // mean template score over the run
+    };
+
+    //==============================================================================
+    /** Collects frames in position order and merges repeated chords. */
+    class Builder
+    {
+    public:
+        explicit Builder(double sampleRate);
+
+        void addFrame(juce::int64 position, int chordIndex, float score);
+
+        /** Finishes the timeline. The builder is left empty. */
+        std::unique_ptr<ChordTimeline> build();
+
+    private:
+        void finishRun();
+
+        std::unique_ptr<ChordTimeline> timeline;
+        double scoreSum = 0.0;
+        int runLength = 0;
+    };
+
+    //==============================================================================
+    /** Single-slot handoff from a producer thread to the message thread.
+        publish() and take() are each a single atomic exchange; a timeline that
+        is published again before it has been taken is simply replaced.
+    */
+    class Mailbox
+    {
+    public:
+        Mailbox() = default;
+        ~Mailbox()                                          { delete pending.exchange(nullptr); }
+
+        void publish(std::unique_ptr<ChordTimeline> timeline) noexcept
+        {
+            delete pending.exchange(timeline.release(), std::memory_order_acq_rel);
+        }
+
+        /** Returns the newest published timeline, or nullptr if there's nothing new. */
+        std::unique_ptr<ChordTimeline> take() noexcept
+        {
+            return std::unique_ptr<ChordTimeline>(pending.exchange(nullptr, std::memory_order_acq_rel));
+        }
+
+    private:
+        std::atomic<ChordTimeline*> pending { nullptr };
+
+        JUCE_DECLARE_NON_COPYABLE (Mailbox)
+    };
+
+    //==============================================================================
+    double getSampleRate() const noexcept                   { return sampleRate; }
+    int getNumSegments() const noexcept                     { return (int) startSamples.size(); }
+    Segment getSegment(int index) const noexcept;
+
+    /** Index of the segment containing the sample, or -1 if it is before the first one. O(log n). */
+    int getSegmentIndexAt(juce::int64 sample) const noexcept;
+
+    /** The chord at a position in seconds, or -1 if there isn't one. */
+    int getChordAt(double timeInSeconds) const noexcept;
+
+    /** The chord of the last segment that has one, or -1. */
+    int getLastChordIndex() const noexcept;
+
+    size_t getMemoryUsage() const noexcept;
+
+private:
+    explicit ChordTimeline(double rate) : sampleRate(rate) {}
+
+    const double sampleRate;
+    std::vector<juce::int64> startSamples;
+    std::vector<juce::int16> chords;
+    std::vector<float> confidences;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChordTimeline)
+};
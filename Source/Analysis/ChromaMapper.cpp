@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    ChromaMapper.cpp
+
+  ==============================================================================
+*/
+
+#include "ChromaMapper.h"
+#include <map>
+
+void ChromaMapper::prepare(double sampleRate, int fftOrder)
+{
+    if (isPreparedFor(sampleRate, fftOrder))
+        return;
+
+    preparedSampleRate = sampleRate;
+    preparedOrder = fftOrder;
+
+    const int fftSize = 1 << fftOrder;
+    const int numBins = fftSize / 2;
+
+    weights.assign((size_t) numBins, 0.0f);
+    bands.clear();
+
+    for (int bin = 1; bin < numBins - 1; ++bin)
+    {
+        // Each bin belongs to the nearest equal-tempered note, i.e. +-50 cents around it
+        const double freq = bin * sampleRate / fftSize;
+        const int note = (int) std::floor(12.0 * std::log2(freq / 440.0) + 69.0 + 0.5);
+
+        if (note < lowestNote || note > highestNote)
+            continue;
+
+        weights[(size_t) bin] = 1.0f;
+
+        const int pitchClass = note % 12;
+        if (! bands.empty() && bands.back().endBin == bin && bands.back().pitchClass == pitchClass)
+            bands.back().endBin = bin + 1;
+        else
+            bands.push_back({ bin, bin + 1, pitchClass });
+    }
+}
+
+std::shared_ptr<const ChromaMapper> ChromaMapper::getShared(double sampleRate, int fftOrder)
+{
+    static juce::CriticalSection lock;
+    static std::map<std::pair<double, int>, std::weak_ptr<const ChromaMapper>> mappers;
+
+    const juce::ScopedLock sl(lock);
+
+    for (auto it = mappers.begin(); it != mappers.end();)
+        it = it->second.expired() ? mappers.erase(it) : std::next(it);
+
+    auto& shared = mappers[{ sampleRate, fftOrder }];
+
+    if (auto existing = shared.lock())
+        return existing;
+
+    auto mapper = std::make_shared<ChromaMapper>();
+    mapper->prepare(sampleRate, fftOrder);
+    shared = mapper;
+    return mapper;
+}
+
+void ChromaMapper::computePitchClassProfile(const float* magnitudes, float* pitchClassProfile, float* peakScratch) const noexcept
+{
+    const int numBins = getNumBins();
+    const float* w = weights.data();
+
+    // Pass 1: keep only local maxima. Written without branches so it vectorises.
+    peakScratch[0] = 0.0f;
+    peakScratch[numBins - 1] = 0.0f;
+
+    for (int i = 1; i < numBins - 1; ++i)
+    {
+        const float mag = magnitudes[i];
+        const bool isPeak = mag > magnitudes[i - 1] && mag > magnitudes[i + 1];
+        peakScratch[i] = isPeak ? mag * w[i] : 0.0f;
+    }
+
+    // Pass 2: sum each run of bins into its pitch class
+    std::fill(pitchClassProfile, pitchClassProfile + 12, 0.0f);
+
+    for (const auto& band : bands)
+    {
+        float sum = 0.0f;
+        for (int i = band.startBin; i < band.endBin; ++i)
+            sum += peakScratch[i];
+
+        pitchClassProfile[band.pitchClass] += sum;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    ChromaMapper.h
+
+    Maps FFT bins to pitch classes. The tables are built once per
+    (sample rate, FFT order), after which turning a magnitude spectrum into a
+    pitch class profile is two straight passes over the bins with no
+    transcendental maths, branches or allocation.
+
+    The tables never change once built, so engines normally take a shared
+    copy from getShared() rather than building their own.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+class ChromaMapper
+{
+public:
+    ChromaMapper() = default;
+
+    /** Rebuilds the tables if the sample rate or FFT order has changed. */
+    void prepare(double sampleRate, int fftOrder);
+
+    /** A prepared mapper shared by everything in the process that asks for the
+        same sample rate and FFT order. It is freed when the last holder lets go.
+    */
+    static std::shared_ptr<const ChromaMapper> getShared(double sampleRate, int fftOrder);
+
+    bool isPreparedFor(double sampleRate, int fftOrder) const noexcept
+    {
+        return sampleRate == preparedSampleRate && fftOrder == preparedOrder;
+    }
+
+    /** Number of magnitudes computePitchClassProfile() reads, i.e. half the FFT size. */
+    int getNumBins() const noexcept     { return (int) weights.size(); }
+
+    /** Sums the spectral peaks of each pitch class into pitchClassProfile[12].
+
+        @param magnitudes   getNumBins() magnitudes from a frequency-only FFT
+        @param peakScratch  getNumBins() floats of scratch space owned by the caller
+    */
+    void computePitchClassProfile(const float* magnitudes, float* pitchClassProfile, float* peakScratch) const noexcept;
+
+    // Bins are mapped over the 8 octaves C0..B7, as the original peak picker did.
+    static constexpr int lowestNote = 12;   // MIDI C0
+    static constexpr int highestNote = 107; // MIDI B7
+
+private:
+    // Consecutive bins always share a pitch class for a while, so the profile
+    // is a sum over contiguous runs rather than a scatter per bin.
+    struct Band
+    {
+        int startBin, endBin, pitchClass;
+    };
+
+    double preparedSampleRate = 0.0;
+    int preparedOrder = 0;
+
+    std::vector<float> weights;     // per bin, 0 outside the mapped range
+    std::vector<Band> bands;
+
+    JUCE_LEAK_DETECTOR (ChromaMapper)
+};
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    ConstantQChroma.cpp
+
+  ==============================================================================
+*/
+
+#include "ConstantQChroma.h"
+#include <map>
+#include <tuple>
+
+void ConstantQChroma::prepare(double sampleRate, int fftOrder, int frameSize)
+{
+    if (isPreparedFor(sampleRate, fftOrder, frameSize))
+        return;
+
+    preparedSampleRate = sampleRate;
+    preparedOrder = fftOrder;
+    preparedFrameSize = frameSize;
+
+    const int fftSize = 1 << fftOrder;
+    jassert(frameSize <= fftSize);
+
+    juce::dsp::FFT fft(fftOrder);
+    std::vector<juce::dsp::Complex<float>> temporalKernel((size_t) fftSize), spectralKernel((size_t) fftSize);
+
+    entries.clear();
+    rows.clear();
+
+    // Q periods of a note at or above this fit in the frame
+    const double lowestFullQ = q * sampleRate / frameSize;
+    firstNote = juce::jlimit(lowestNote, highestNote + 1, (int) std::ceil(69.0 + 12.0 * std::log2(lowestFullQ / 440.0)));
+
+    for (int note = firstNote; note <= highestNote; ++note)
+    {
+        const double freq = 440.0 * std::pow(2.0, (note - 69) / 12.0);
+
+        if (freq >= sampleRate / 2)
+            break;
+
+        // Q periods of the note, centred in the frame
+        const int length = (int) std::ceil(q * sampleRate / freq);
+        const int start = (frameSize - length) / 2;
+
+        if (length > frameSize)
+        {
+            firstNote = note + 1;   // only at the rounding edge of the estimate
+            continue;
+        }
+
+        std::fill(temporalKernel.begin(), temporalKernel.end(), juce::dsp::Complex<float>());
+
+        for (int n = 0; n < length; ++n)
+        {
+            const double window = 0.5 * (1.0 - std::cos(2.0 * juce::MathConstants<double>::pi * n / juce::jmax(1, length - 1)));
+            const double phase = 2.0 * juce::MathConstants<double>::pi * freq * n / sampleRate;
+            temporalKernel[(size_t) (start + n)] = { (float) (window / length * std::cos(phase)),
+                                                     (float) (window / length * std::sin(phase)) };
+        }
+
+        fft.perform(temporalKernel.data(), spectralKernel.data(), false);
+
+        // A real signal's spectrum is symmetric and the kernel's energy is all at
+        // positive frequencies, so only bins 0..fftSize/2 are kept
+        float largest = 0.0f;
+        for (int bin = 0; bin <= fftSize / 2; ++bin)
+            largest = juce::jmax(largest, std::abs(spectralKernel[(size_t) bin]));
+
+        Row row { (int) entries.size(), 0, note % 12 };
+
+        for (int bin = 0; bin <= fftSize / 2; ++bin)
+        {
+            const auto k = spectralKernel[(size_t) bin];
+
+            // Parseval: sum(x * conj(t)) = sum(X * conj(T)) / fftSize
+            if (std::abs(k) >= largest * sparsityThreshold)
+                entries.push_back({ bin, k.real() / (float) fftSize, -k.imag() / (float) fftSize });
+        }
+
+        row.endEntry = (int) entries.size();
+        rows.push_back(row);
+    }
+
+    entries.shrink_to_fit();
+}
+
+std::shared_ptr<const ConstantQChroma> ConstantQChroma::getShared(double sampleRate, int fftOrder, int frameSize)
+{
+    static juce::CriticalSection lock;
+    static std::map<std::tuple<double, int, int>, std::weak_ptr<const ConstantQChroma>> kernels;
+
+    // Held while building, so a kernel wanted by several threads at once is only built once
+    const juce::ScopedLock sl(lock);
+
+    for (auto it = kernels.begin(); it != kernels.end();)
+        it = it->second.expired() ? kernels.erase(it) : std::next(it);
+
+    auto& shared = kernels[{ sampleRate, fftOrder, frameSize }];
+
+    if (auto existing = shared.lock())
+        return existing;
+
+    auto kernel = std::make_shared<ConstantQChroma>();
+    kernel->prepare(sampleRate, fftOrder, frameSize);
+    shared = kernel;
+    return kernel;
+}
+
+void ConstantQChroma::computePitchClassProfile(const float* spectrum, float* pitchClassProfile) const noexcept
+{
+    std::fill(pitchClassProfile, pitchClassProfile + 12, 0.0f);
+
+    const Entry* e = entries.data();
+
+    for (const auto& row : rows)
+    {
+        float re = 0.0f, im = 0.0f;
+
+        for (int i = row.firstEntry; i < row.endEntry; ++i)
+        {
+            const float xr = spectrum[2 * e[i].bin];
+            const float xi = spectrum[2 * e[i].bin + 1];
+            re += xr * e[i].re - xi * e[i].im;
+            im += xr * e[i].im + xi * e[i].re;
+        }
+
+        pitchClassProfile[row.pitchClass] += std::sqrt(re * re + im * im);
+    }
+}
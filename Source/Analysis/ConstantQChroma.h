@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    ConstantQChroma.h
+
+    Pitch class profile from a constant-Q transform, computed the
+    Brown-Puckette way: one ordinary FFT of the frame, then a sparse
+    matrix-vector product with a precomputed spectral kernel.
+
+    Each row of the kernel is the spectrum of one note's temporal kernel, a
+    windowed complex sinusoid whose length is Q periods of the note, so the
+    bass gets long windows and narrow bands while the treble gets short ones.
+    Only notes whose Q periods fit in the frame get a row. A kernel cut
+    short by the frame would be no narrower than an FFT bin and would smear
+    across neighbouring semitones, so lower notes count only through their
+    harmonics. At 44.1 kHz the rows start at F#3 with 4096-sample frames
+    and at F#1 with 16384-sample frames, so the high-resolution preset is
+    the one that resolves the bass. Those spectra are concentrated around the note's
+    frequency, so after dropping the near-zero coefficients only a few bins
+    per row remain. The rows are stored in CSR form: one contiguous array of
+    (bin, coefficient) entries and an offset per row, walked front to back.
+
+    Building the kernel takes one FFT per note and it can run to a few
+    hundred kilobytes, so engines share one per (sample rate, FFT order,
+    frame size) through getShared().
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+class ConstantQChroma
+{
+public:
+    ConstantQChroma() = default;
+
+    /** Rebuilds the kernel if the sample rate, FFT order or frame size has changed.
+        This runs one complex FFT per note, so do it off the audio thread.
+    */
+    void prepare(double sampleRate, int fftOrder, int frameSize);
+
+    /** A prepared kernel shared by everything in the process that asks for the
+        same parameters. It is freed when the last holder lets go.
+    */
+    static std::shared_ptr<const ConstantQChroma> getShared(double sampleRate, int fftOrder, int frameSize);
+
+    bool isPreparedFor(double sampleRate, int fftOrder, int frameSize) const noexcept
+    {
+        return sampleRate == preparedSampleRate && fftOrder == preparedOrder && frameSize == preparedFrameSize;
+    }
+
+    /** Sums the constant-Q magnitudes of each pitch class into pitchClassProfile[12].
+
+        @param spectrum     the frame's unwindowed spectrum, as left by
+                            FFT::performRealOnlyForwardTransform (data, true):
+                            interleaved real/imaginary pairs for bins 0 to fftSize / 2
+    */
+    void computePitchClassProfile(const float* spectrum, float* pitchClassProfile) const noexcept;
+
+    int getNumNotes() const noexcept        { return (int) rows.size(); }
+    int getNumNonZeros() const noexcept     { return (int) entries.size(); }
+
+    /** The lowest note with a row: the first whose full-Q kernel fits in the frame. */
+    int getLowestNote() const noexcept      { return firstNote; }
+
+    // The range ChromaMapper covers; this one starts wherever the frame allows
+    static constexpr int lowestNote = 12;   // MIDI C0
+    static constexpr int highestNote = 107; // MIDI B7
+
+    // One band per semitone: Q = 1 / (2^(1/12) - 1)
+    static constexpr double q = 16.817153745105756;
+
+    // Kernel coefficients below this fraction of their row's largest are dropped
+    static constexpr float sparsityThreshold = 0.01f;
+
+private:
+    struct Entry
+    {
+        int bin;
+        float re, im;   // conjugated and scaled by 1 / fftSize
+    };
+
+    struct Row
+    {
+        int firstEntry, endEntry, pitchClass;
+    };
+
+    double preparedSampleRate = 0.0;
+    int preparedOrder = 0, preparedFrameSize = 0;
+    int firstNote = lowestNote;
+
+    std::vector<Entry> entries;
+    std::vector<Row> rows;
+
+    JUCE_LEAK_DETECTOR (ConstantQChroma)
+};
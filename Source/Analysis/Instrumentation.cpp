@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    Instrumentation.cpp
+
+  ==============================================================================
+*/
+
+#include "Instrumentation.h"
+
+namespace Instrumentation
+{
+    namespace
+    {
+        int getHistogramBucket(double microseconds) noexcept
+        {
+            if (microseconds < 2.0)
+                return 0;
+
+            return juce::jmin(StageCounters::numHistogramBuckets - 1, (int) std::log2(microseconds));
+        }
+
+        // Lock-free running maximum
+        void updateMaximum(std::atomic<double>& maximum, double value) noexcept
+        {
+            auto current = maximum.load(std::memory_order_relaxed);
+
+            while (value > current && ! maximum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+
+    const char* getStageName(Stage stage) noexcept
+    {
+        switch (stage)
+        {
+            case Stage::frameRead:  return "read";
+            case Stage::window:     return "window";
+            case Stage::fft:        return "fft";
+            case Stage::chroma:     return "chroma";
+            case Stage::match:      return "match";
+            case Stage::onset:      return "onset";
+            case Stage::frame:      return "frame";
+            case Stage::beats:      return "beats";
+            case Stage::numStages:  break;
+        }
+
+        return "";
+    }
+
+    //==============================================================================
+    void StageCounters::add(Stage stage, juce::int64 ticks, juce::uint64 cycles) noexcept
+    {
+        auto& t = totals[(int) stage];
+        t.count.fetch_add(1, std::memory_order_relaxed);
+        t.ticks.fetch_add((juce::uint64) ticks, std::memory_order_relaxed);
+        t.cycles.fetch_add(cycles, std::memory_order_relaxed);
+
+        if (stage == Stage::frame)
+        {
+            const auto microseconds = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+            histogram[getHistogramBucket(microseconds)].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void StageCounters::reset() noexcept
+    {
+        for (auto& t : totals)
+        {
+            t.count.store(0);
+            t.ticks.store(0);
+            t.cycles.store(0);
+        }
+
+        for (auto& bucket : histogram)
+            bucket.store(0);
+    }
+
+    StageCounters::StageTotals StageCounters::getTotals(Stage stage) const noexcept
+    {
+        auto& t = totals[(int) stage];
+
+        StageTotals result;
+        result.count = t.count.load(std::memory_order_relaxed);
+        result.seconds = juce::Time::highResolutionTicksToSeconds((juce::int64) t.ticks.load(std::memory_order_relaxed));
+        result.cycles = t.cycles.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    juce::uint64 StageCounters::getHistogramCount(int bucket) const noexcept
+    {
+        return histogram[bucket].load(std::memory_order_relaxed);
+    }
+
+    double StageCounters::getFramePercentile(double fraction) const noexcept
+    {
+        juce::uint64 total = 0;
+        for (int i = 0; i < numHistogramBuckets; ++i)
+            total += getHistogramCount(i);
+
+        if (total == 0)
+            return 0.0;
+
+        const auto target = (juce::uint64) std::ceil(fraction * (double) total);
+        juce::uint64 seen = 0;
+
+        for (int i = 0; i < numHistogramBuckets; ++i)
+        {
+            seen += getHistogramCount(i);
+
+            if (seen >= target)
+                return std::exp2((double) (i + 1));
+        }
+
+        return std::exp2((double) numHistogramBuckets);
+    }
+
+    juce::String StageCounters::getSummary() const
+    {
+        if (! isEnabled())
+            return "Instrumentation disabled in this build";
+
+        juce::String summary;
+
+        for (int i = 0; i < (int) Stage::frame; ++i)
+            summary << getStageName((Stage) i) << " " << juce::String(getTotals((Stage) i).getMicrosecondsPerCall(), 1) << "  ";
+
+        summary << "us/frame;  p50 < " << getFramePercentile(0.5) << " us, p99 < " << getFramePercentile(0.99) << " us";
+        return summary;
+    }
+
+    juce::String StageCounters::createReport() const
+    {
+        juce::String report;
+        report << "stage,calls,total_ms,us_per_call,cycles_per_call\n";
+
+        for (int i = 0; i < numStages; ++i)
+        {
+            const auto t = getTotals((Stage) i);
+
+            report << getStageName((Stage) i) << ',' << (juce::int64) t.count << ','
+                   << juce::String(t.seconds * 1000.0, 3) << ','
+                   << juce::String(t.getMicrosecondsPerCall(), 3) << ','
+                   << (t.count > 0 ? (juce::int64) (t.cycles / t.count) : 0) << '\n';
+        }
+
+        report << "\nframe_us_from,frame_us_to,frames\n";
+
+        for (int i = 0; i < numHistogramBuckets; ++i)
+            report << (i == 0 ? 0 : (1 << i)) << ',' << (1 << (i + 1)) << ',' << (juce::int64) getHistogramCount(i) << '\n';
+
+        return report;
+    }
+
+    StageCounters& getAnalysisCounters() noexcept
+    {
+        static StageCounters counters;
+        return counters;
+    }
+
+    //==============================================================================
+    void BlockStats::add(juce::int64 ticks, int numSamples, double sampleRate) noexcept
+    {
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return;
+
+        const auto milliseconds = juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+        const auto deadlineMs = 1000.0 * numSamples / sampleRate;
+        const auto load = milliseconds / deadlineMs;
+
+        numBlocks.fetch_add(1, std::memory_order_relaxed);
+
+        if (load > 1.0)
+            numOverruns.fetch_add(1, std::memory_order_relaxed);
+
+        if (load > worstLoad.load(std::memory_order_relaxed))
+        {
+            worstMs.store(milliseconds, std::memory_order_relaxed);
+            worstDeadlineMs.store(deadlineMs, std::memory_order_relaxed);
+        }
+
+        updateMaximum(worstLoad, load);
+    }
+
+    void BlockStats::reset() noexcept
+    {
+        numBlocks.store(0);
+        numOverruns.store(0);
+        worstMs.store(0.0);
+        worstDeadlineMs.store(0.0);
+        worstLoad.store(0.0);
+    }
+
+    juce::String BlockStats::getSummary() const
+    {
+        if (! isEnabled())
+            return {};
+
+        return "Block worst " + juce::String(getWorstMilliseconds(), 2) + " of " + juce::String(getWorstDeadlineMilliseconds(), 2)
+             + " ms (" + juce::String(getWorstLoad() * 100.0, 0) + "%), "
+             + juce::String((juce::int64) getNumOverruns()) + " overruns in " + juce::String((juce::int64) getNumBlocks()) + " blocks";
+    }
+
+    //==============================================================================
+    bool dumpToFile(const juce::File& file, const BlockStats* blockStats)
+    {
+        juce::String text;
+        text << "VST Sampler instrumentation, " << juce::Time::getCurrentTime().toString(true, true) << "\n\n"
+             << getAnalysisCounters().createReport();
+
+        if (blockStats != nullptr)
+        {
+            text << "\nblocks,overruns,worst_ms,worst_deadline_ms,worst_load\n"
+                 << (juce::int64) blockStats->getNumBlocks() << ',' << (juce::int64) blockStats->getNumOverruns() << ','
+                 << juce::String(blockStats->getWorstMilliseconds(), 3) << ','
+                 << juce::String(blockStats->getWorstDeadlineMilliseconds(), 3) << ','
+                 << juce::String(blockStats->getWorstLoad(), 3) << '\n';
+        }
+
+        return file.replaceWithText(text);
+    }
+}
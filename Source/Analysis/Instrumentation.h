@@ -0,0 +1,191 @@
+/*
+  ==============================================================================
+
+    Instrumentation.h
+
+    Always-on timing for the analysis hot path and the audio callback.
+
+    Each analysis stage (frame read, window, FFT, chroma, match, and the whole
+    frame) adds its time and CPU cycles to process-wide counters with relaxed
+    atomic adds, so any number of analysis threads can record at once without
+    locking. Whole-frame times also go into a log2 histogram. The audio
+    callback keeps its own BlockStats: worst block time against the block's
+    deadline, and how often the deadline was missed.
+
+    Build with VST_SAMPLER_INSTRUMENTATION=0 to compile the timers out
+    entirely; the counters then stay at zero.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+#ifndef VST_SAMPLER_INSTRUMENTATION
+ #define VST_SAMPLER_INSTRUMENTATION 1
+#endif
+
+#if VST_SAMPLER_INSTRUMENTATION && JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+namespace Instrumentation
+{
+    constexpr bool isEnabled() noexcept     { return VST_SAMPLER_INSTRUMENTATION != 0; }
+
+    enum class Stage
+    {
+        frameRead,
+        window,
+        fft,
+        chroma,
+        match,
+        onset,      // spectral flux, beat-synchronous analysis only
+        frame,      // everything for one frame, read to result
+        beats,      // tempo, beats and per-beat chords, once per file
+        numStages
+    };
+
+    constexpr int numStages = (int) Stage::numStages;
+    const char* getStageName(Stage) noexcept;
+
+    /** Time-stamp counter where there is one (x86), otherwise 0. */
+    inline juce::uint64 readCycleCounter() noexcept
+    {
+       #if VST_SAMPLER_INSTRUMENTATION && JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #else
+        return 0;
+       #endif
+    }
+
+    //==============================================================================
+    /** Per-stage totals plus a histogram of whole-frame times. */
+    class StageCounters
+    {
+    public:
+        // Bucket n counts frames that took [2^n, 2^(n+1)) microseconds; bucket 0 also takes anything faster
+        static constexpr int numHistogramBuckets = 24;
+
+        void add(Stage, juce::int64 ticks, juce::uint64 cycles) noexcept;
+        void reset() noexcept;
+
+        struct StageTotals
+        {
+            juce::uint64 count = 0;
+            double seconds = 0.0;
+            juce::uint64 cycles = 0;
+
+            double getMicrosecondsPerCall() const noexcept  { return count > 0 ? seconds * 1.0e6 / (double) count : 0.0; }
+        };
+
+        StageTotals getTotals(Stage) const noexcept;
+        juce::uint64 getHistogramCount(int bucket) const noexcept;
+
+        /** Upper bound of the histogram bucket holding the given fraction of frames, in microseconds. */
+        double getFramePercentile(double fraction) const noexcept;
+
+        /** One line, for the editor's overlay. */
+        juce::String getSummary() const;
+
+        /** Every stage and the full histogram. */
+        juce::String createReport() const;
+
+    private:
+        struct Totals
+        {
+            std::atomic<juce::uint64> count { 0 }, ticks { 0 }, cycles { 0 };
+        };
+
+        Totals totals[numStages];
+        std::atomic<juce::uint64> histogram[numHistogramBuckets] = {};
+    };
+
+    /** The counters every analysis thread records into. */
+    StageCounters& getAnalysisCounters() noexcept;
+
+    //==============================================================================
+    /** Audio callback timing. Written only by the audio thread. */
+    class BlockStats
+    {
+    public:
+        void add(juce::int64 ticks, int numSamples, double sampleRate) noexcept;
+        void reset() noexcept;
+
+        juce::uint64 getNumBlocks() const noexcept              { return numBlocks.load(std::memory_order_relaxed); }
+        juce::uint64 getNumOverruns() const noexcept            { return numOverruns.load(std::memory_order_relaxed); }
+        double getWorstMilliseconds() const noexcept            { return worstMs.load(std::memory_order_relaxed); }
+        double getWorstDeadlineMilliseconds() const noexcept    { return worstDeadlineMs.load(std::memory_order_relaxed); }
+
+        /** The highest fraction of its deadline any block has used. */
+        double getWorstLoad() const noexcept                    { return worstLoad.load(std::memory_order_relaxed); }
+
+        juce::String getSummary() const;
+
+    private:
+        std::atomic<juce::uint64> numBlocks { 0 }, numOverruns { 0 };
+        std::atomic<double> worstMs { 0.0 }, worstDeadlineMs { 0.0 }, worstLoad { 0.0 };
+    };
+
+    //==============================================================================
+   #if VST_SAMPLER_INSTRUMENTATION
+    class ScopedStage
+    {
+    public:
+        explicit ScopedStage(Stage s) noexcept
+            : stage(s), startTicks(juce::Time::getHighResolutionTicks()), startCycles(readCycleCounter()) {}
+
+        ~ScopedStage() noexcept
+        {
+            getAnalysisCounters().add(stage, juce::Time::getHighResolutionTicks() - startTicks, readCycleCounter() - startCycles);
+        }
+
+    private:
+        const Stage stage;
+        const juce::int64 startTicks;
+        const juce::uint64 startCycles;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedStage)
+    };
+
+    class ScopedBlockTimer
+    {
+    public:
+        ScopedBlockTimer(BlockStats& s, int numSamplesInBlock, double rate) noexcept
+            : stats(s), numSamples(numSamplesInBlock), sampleRate(rate), startTicks(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedBlockTimer() noexcept
+        {
+            stats.add(juce::Time::getHighResolutionTicks() - startTicks, numSamples, sampleRate);
+        }
+
+    private:
+        BlockStats& stats;
+        const int numSamples;
+        const double sampleRate;
+        const juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlockTimer)
+    };
+   #endif
+
+    /** Writes the analysis report and the block stats to a text file. */
+    bool dumpToFile(const juce::File&, const BlockStats* blockStats);
+}
+
+#if VST_SAMPLER_INSTRUMENTATION
+ #define VST_SAMPLER_SCOPED_STAGE(stage) \
+    const Instrumentation::ScopedStage JUCE_JOIN_MACRO (scopedStage_, __LINE__) (Instrumentation::Stage::stage)
+
+ #define VST_SAMPLER_SCOPED_BLOCK(blockStats, numSamples, sampleRate) \
+    const Instrumentation::ScopedBlockTimer JUCE_JOIN_MACRO (scopedBlock_, __LINE__) (blockStats, numSamples, sampleRate)
+#else
+ #define VST_SAMPLER_SCOPED_STAGE(stage)
+ #define VST_SAMPLER_SCOPED_BLOCK(blockStats, numSamples, sampleRate)
+#endif
@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+    LiveChordDetector.cpp
+
+  ==============================================================================
+*/
+
+#include "LiveChordDetector.h"
+#include "Instrumentation.h"
+#include <algorithm>
+#include <cmath>
+
+LiveChordDetector::LiveChordDetector()
+    : juce::Thread("Live chord detection"),
+      displayColumns((size_t) maxDisplayColumns)
+{
+}
+
+LiveChordDetector::~LiveChordDetector()
+{
+    release();
+}
+
+void LiveChordDetector::prepare(double sampleRate, int maximumBlockSize, const AnalysisSettings& newSettings)
+{
+    // The analysis thread reads the settings, so they only change while it is stopped
+    release();
+
+    settings = newSettings.isValid() ? newSettings : AnalysisSettings();
+    isComplexSpectrum = settings.chroma == AnalysisSettings::Chroma::constantQ;
+    currentSampleRate = sampleRate > 0.0 ? sampleRate : 44100.0;
+    frameSize = settings.getFrameSize();
+    hopSize = juce::jmin(settings.getHopSize(currentSampleRate), frameSize);
+
+    // Room for about half a second of audio, and never less than a few blocks
+    // plus a full frame, so the analysis thread can be descheduled for a while.
+    const int capacity = juce::jmax((int) currentSampleRate / 2, frameSize + 4 * maximumBlockSize);
+    fifo.setTotalSize(capacity);
+    fifoBuffer.assign((size_t) capacity, 0.0f);
+
+    analyzer.prepare(currentSampleRate, settings);
+    frame.assign((size_t) frameSize, 0.0f);
+
+    samplesWritten.store(0);
+    samplesRead = 0;
+    packedSnapshot.store(0);
+    changeFifo.reset();
+    lastQueuedChord = -2;
+
+    // Log-spaced display bands, each at least one bin wide. The display queue
+    // is left alone: a view may be reading it, and its columns are still valid.
+    const int numBins = analyzer.getNumBins();
+    const double binHz = currentSampleRate / analyzer.getFftSize();
+    const double lowHz = 40.0, highHz = juce::jmin(16000.0, 0.5 * currentSampleRate);
+
+    for (int band = 0; band <= DisplayColumn::numBands; ++band)
+    {
+        const auto hz = lowHz * std::pow(highHz / lowHz, (double) band / DisplayColumn::numBands);
+        bandEdges[(size_t) band] = juce::jlimit(1, numBins - 1, juce::roundToInt(hz / binHz));
+    }
+
+    resetStats();
+
+    startThread();
+}
+
+void LiveChordDetector::release()
+{
+    stopThread(1000);
+    fifo.reset();
+}
+
+void LiveChordDetector::pushSamples(const juce::AudioBuffer<float>& buffer, int numChannels) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    numChannels = juce::jmin(numChannels, buffer.getNumChannels());
+
+    if (! enabled.load(std::memory_order_relaxed) || numChannels <= 0 || numSamples <= 0 || fifoBuffer.empty())
+        return;
+
+    if (fifo.getFreeSpace() < numSamples)
+    {
+        samplesDropped.fetch_add(numSamples, std::memory_order_relaxed);
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    const float gain = 1.0f / (float) numChannels;
+
+    auto mixInto = [&](int fifoStart, int sourceStart, int num)
+    {
+        auto* dest = fifoBuffer.data() + fifoStart;
+        juce::FloatVectorOperations::copyWithMultiply(dest, buffer.getReadPointer(0, sourceStart), gain, num);
+
+        for (int channel = 1; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::addWithMultiply(dest, buffer.getReadPointer(channel, sourceStart), gain, num);
+    };
+
+    if (size1 > 0) mixInto(start1, 0, size1);
+    if (size2 > 0) mixInto(start2, size1, size2);
+
+    fifo.finishedWrite(size1 + size2);
+
+    lastWriteTicks.store(juce::Time::getHighResolutionTicks(), std::memory_order_relaxed);
+    samplesWritten.fetch_add(size1 + size2, std::memory_order_release);
+}
+
+void LiveChordDetector::run()
+{
+    // Poll a few times per hop: the audio thread can't signal us without locking.
+    const int pollIntervalMs = juce::jmax(1, (int) (1000.0 * hopSize / currentSampleRate / 8.0));
+
+    while (! threadShouldExit())
+    {
+        if (fifo.getNumReady() < hopSize)
+        {
+            wait(pollIntervalMs);
+            continue;
+        }
+
+        readHop();
+
+        // If another hop is already waiting we are behind, so only analyse the
+        // most recent frame and count the ones we step over.
+        if (fifo.getNumReady() >= hopSize)
+            framesSkipped.fetch_add(1, std::memory_order_relaxed);
+        else
+            analyseFrame();
+    }
+}
+
+void LiveChordDetector::readHop()
+{
+    // Slide the frame along by one hop and append the new samples
+    std::copy(frame.begin() + hopSize, frame.end(), frame.begin());
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(hopSize, start1, size1, start2, size2);
+
+    auto* dest = frame.data() + (frameSize - hopSize);
+    std::copy_n(fifoBuffer.data() + start1, size1, dest);
+    std::copy_n(fifoBuffer.data() + start2, size2, dest + size1);
+
+    fifo.finishedRead(size1 + size2);
+    samplesRead += size1 + size2;
+}
+
+void LiveChordDetector::analyseFrame()
+{
+    VST_SAMPLER_SCOPED_STAGE (frame);
+
+    const float* channels[] = { frame.data() };
+    const auto result = analyzer.analyseFrame(channels, 1);
+    publish(result.chordIndex, result.score);
+    queueChange(result.chordIndex);
+
+    if (displayEnabled.load(std::memory_order_relaxed))
+        queueDisplayColumn(result.chordIndex);
+
+    // The newest sample in this frame arrived roughly when the block holding it
+    // was pushed, so work back from the most recent push.
+    const auto written = samplesWritten.load(std::memory_order_acquire);
+    const auto writeTicks = lastWriteTicks.load(std::memory_order_relaxed);
+    const double sinceLastWrite = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - writeTicks);
+    const double queuedSeconds = (double) (written - samplesRead) / currentSampleRate;
+    const double halfWindowSeconds = 0.5 * frameSize / currentSampleRate;
+    const double latency = 1000.0 * (sinceLastWrite + queuedSeconds + halfWindowSeconds);
+
+    latencyMs.store(latency, std::memory_order_relaxed);
+    if (latency > maxLatencyMs.load(std::memory_order_relaxed))
+        maxLatencyMs.store(latency, std::memory_order_relaxed);
+
+    framesAnalysed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LiveChordDetector::publish(int chordIndex, float score) noexcept
+{
+    ++frameCounter;
+
+    juce::uint32 scoreBits;
+    std::memcpy(&scoreBits, &score, sizeof(scoreBits));
+
+    const auto packed = (juce::uint64) scoreBits
+                      | ((juce::uint64) (juce::uint16) (chordIndex + 1) << 32)
+                      | ((juce::uint64) (frameCounter & 0xffff) << 48);
+
+    packedSnapshot.store(packed, std::memory_order_release);
+}
+
+void LiveChordDetector::queueChange(int chordIndex) noexcept
+{
+    if (chordIndex == lastQueuedChord)
+        return;
+
+    // A full queue means the audio thread isn't draining it; try again next frame
+    if (changeFifo.getFreeSpace() < 1)
+        return;
+
+    int start1, size1, start2, size2;
+    changeFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    // The frame is centred half a frame before its newest sample, and the
+    // output is delayed by half a frame plus a hop
+    changes[(size_t) start1] = { samplesRead + hopSize, chordIndex };
+    changeFifo.finishedWrite(1);
+    lastQueuedChord = chordIndex;
+}
+
+void LiveChordDetector::queueDisplayColumn(int chordIndex) noexcept
+{
+    if (displayFifo.getFreeSpace() < 1)
+        return;
+
+    int start1, size1, start2, size2;
+    displayFifo.prepareToWrite(1, start1, size1, start2, size2);
+    auto& column = displayColumns[(size_t) start1];
+    column.chordIndex = chordIndex;
+
+    const auto* profile = analyzer.getPitchClassProfile();
+    const auto strongest = juce::FloatVectorOperations::findMaximum(profile, 12);
+
+    for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+        column.chroma[(size_t) pitchClass] = strongest > 0.0f ? profile[pitchClass] / strongest : 0.0f;
+
+    // Peak picking leaves magnitudes behind, constant-Q the interleaved complex bins
+    const auto* spectrum = analyzer.getMagnitudes();
+    const float fullScale = 0.25f * (float) frameSize;    // a full-scale sine under the Hann window
+
+    for (int band = 0; band < DisplayColumn::numBands; ++band)
+    {
+        const int first = bandEdges[(size_t) band];
+        const int last = juce::jmax(first + 1, bandEdges[(size_t) band + 1]);
+        float peak = 0.0f;
+
+        for (int bin = first; bin < last; ++bin)
+            peak = juce::jmax(peak, isComplexSpectrum ? std::hypot(spectrum[2 * bin], spectrum[2 * bin + 1]) : spectrum[bin]);
+
+        const auto decibels = juce::Decibels::gainToDecibels(peak / fullScale, -90.0f);
+        column.spectrum[(size_t) band] = juce::jlimit(0.0f, 1.0f, 1.0f + decibels / 90.0f);
+    }
+
+    displayFifo.finishedWrite(1);
+}
+
+int LiveChordDetector::popDisplayColumns(DisplayColumn* dest, int maxColumns) noexcept
+{
+    int start1, size1, start2, size2;
+    displayFifo.prepareToRead(maxColumns, start1, size1, start2, size2);
+
+    std::copy_n(displayColumns.begin() + start1, size1, dest);
+    std::copy_n(displayColumns.begin() + start2, size2, dest + size1);
+
+    displayFifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+LiveChordDetector::Snapshot LiveChordDetector::getCurrentChord() const noexcept
+{
+    const auto packed = packedSnapshot.load(std::memory_order_acquire);
+
+    Snapshot snapshot;
+    const auto scoreBits = (juce::uint32) (packed & 0xffffffff);
+    std::memcpy(&snapshot.score, &scoreBits, sizeof(scoreBits));
+    snapshot.chordIndex = (int) (juce::uint16) (packed >> 32) - 1;
+    snapshot.frameCount = (juce::uint32) (packed >> 48);
+    return snapshot;
+}
+
+LiveChordDetector::Stats LiveChordDetector::getStats() const noexcept
+{
+    Stats stats;
+    stats.framesAnalysed = framesAnalysed.load(std::memory_order_relaxed);
+    stats.framesSkipped = framesSkipped.load(std::memory_order_relaxed);
+    stats.samplesDropped = samplesDropped.load(std::memory_order_relaxed);
+    stats.latencyMs = latencyMs.load(std::memory_order_relaxed);
+    stats.maxLatencyMs = maxLatencyMs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void LiveChordDetector::resetStats() noexcept
+{
+    framesAnalysed.store(0);
+    framesSkipped.store(0);
+    samplesDropped.store(0);
+    latencyMs.store(0.0);
+    maxLatencyMs.store(0.0);
+}
@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    LiveChordDetector.h
+
+    Streaming chord detection. The audio thread pushes samples into a wait-free
+    single-producer/single-consumer FIFO and a dedicated thread runs the
+    STFT -> PCP -> template match on overlapping frames. The current chord is
+    published as a single atomic word that the editor can poll.
+
+    Chord changes are also queued for the audio thread, each stamped with
+    the stream position where it belongs once the output is delayed by
+    getLatencySamples(): the frame's centre plus the latency. As long as a
+    frame is analysed within a hop of its last sample arriving, the change
+    lands in a block that hasn't been processed yet, at its exact offset.
+
+    While a view asks for them, each frame's chroma and a log-frequency
+    spectrum are queued as a DisplayColumn for the message thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChordAnalyzer.h"
+#include <array>
+#include <atomic>
+#include <vector>
+
+class LiveChordDetector  : private juce::Thread
+{
+public:
+    struct Snapshot
+    {
+        int chordIndex = -1;        // -1 when nothing has been detected yet
+        float score = 0.0f;
+        juce::uint32 frameCount = 0; // wraps at 16 bits, only useful to spot a new frame
+    };
+
+    struct ChordChange
+    {
+        juce::int64 position = 0;   // in samples pushed, see getNumSamplesPushed()
+        int chordIndex = -1;
+    };
+
+    /** One analysed frame for display, with every value scaled to 0..1. */
+    struct DisplayColumn
+    {
+        static constexpr int numBands = 128;
+
+        std::array<float, 12> chroma;               // relative to the frame's strongest pitch class
+        std::array<float, numBands> spectrum;       // 40 Hz to 16 kHz, log-spaced, -90..0 dBFS
+        int chordIndex = -1;
+    };
+
+    struct Stats
+    {
+        juce::int64 framesAnalysed = 0;
+        juce::int64 framesSkipped = 0;  // frames dropped because the analysis thread fell behind
+        juce::int64 samplesDropped = 0; // samples the audio thread could not fit in the FIFO
+        double latencyMs = 0.0;         // last frame: half a window plus the time from arrival to publish
+        double maxLatencyMs = 0.0;
+    };
+
+    LiveChordDetector();
+    ~LiveChordDetector() override;
+
+    /** Stops the analysis thread, applies the settings (frame, FFT and hop
+        sizes, and chroma; a hop of 0 seconds means half a frame), allocates the
+        FIFO and analysis buffers and starts the thread again.
+        Must not be called while the audio thread is pushing samples.
+    */
+    void prepare(double sampleRate, int maximumBlockSize, const AnalysisSettings& newSettings);
+    void release();
+
+    const AnalysisSettings& getSettings() const noexcept            { return settings; }
+
+    /** How far the reported chord lags the audio, for the host's delay
+        compensation: the centre of the frame, plus up to one hop before a
+        new frame is analysed.
+    */
+    int getLatencySamples() const noexcept                          { return frameSize / 2 + hopSize; }
+
+    void setEnabled(bool shouldBeEnabled) noexcept  { enabled.store(shouldBeEnabled); }
+    bool isEnabled() const noexcept                 { return enabled.load(); }
+
+    /** Called from the audio thread. Mixes the first numChannels of the buffer down
+        to mono and appends them to the FIFO. Never blocks or allocates.
+    */
+    void pushSamples(const juce::AudioBuffer<float>& buffer, int numChannels) noexcept;
+
+    /** Samples pushed since prepare(): the stream position at the start of the
+        next pushSamples(). Audio thread only.
+    */
+    juce::int64 getNumSamplesPushed() const noexcept                { return samplesWritten.load(std::memory_order_relaxed); }
+
+    /** Called from the audio thread. Hands each queued chord change due before
+        blockStart + numSamples to callback(sampleOffset, chordIndex), in order.
+        Changes that arrived too late for their block come at offset 0.
+        Never blocks or allocates.
+    */
+    template <typename Callback>
+    void popChordChanges(juce::int64 blockStart, int numSamples, Callback&& callback) noexcept
+    {
+        while (changeFifo.getNumReady() > 0)
+        {
+            int start1, size1, start2, size2;
+            changeFifo.prepareToRead(1, start1, size1, start2, size2);
+            const auto& change = changes[(size_t) start1];
+
+            if (change.position >= blockStart + numSamples)
+                break;
+
+            callback((int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples - 1, change.position - blockStart), change.chordIndex);
+            changeFifo.finishedRead(1);
+        }
+    }
+
+    /** Turns the display columns on or off; off by default, as they cost a little per frame. */
+    void setDisplayEnabled(bool shouldBeEnabled) noexcept           { displayEnabled.store(shouldBeEnabled); }
+
+    /** Called from the message thread. Moves up to maxColumns of the oldest
+        queued columns into dest and returns how many there were.
+    */
+    int popDisplayColumns(DisplayColumn* dest, int maxColumns) noexcept;
+
+    Snapshot getCurrentChord() const noexcept;
+    Stats getStats() const noexcept;
+    void resetStats() noexcept;
+
+private:
+    void run() override;
+    void readHop();
+    void analyseFrame();
+    void publish(int chordIndex, float score) noexcept;
+    void queueChange(int chordIndex) noexcept;
+    void queueDisplayColumn(int chordIndex) noexcept;
+
+    AnalysisSettings settings { AnalysisSettings().withHopSeconds(0.0) };
+    double currentSampleRate = 44100.0;
+    int frameSize = settings.getFrameSize();
+    int hopSize = settings.getHopSize(currentSampleRate);
+    bool isComplexSpectrum = false;             // constant-Q bins, read by the analysis thread
+    std::atomic<bool> enabled { false };
+
+    // Audio thread -> analysis thread
+    juce::AbstractFifo fifo { 1 };
+    std::vector<float> fifoBuffer;
+    std::atomic<juce::int64> samplesWritten { 0 };
+    std::atomic<juce::int64> lastWriteTicks { 0 };
+
+    // Analysis thread only
+    ChordAnalyzer analyzer;
+    std::vector<float> frame;
+    juce::int64 samplesRead = 0;
+    juce::uint32 frameCounter = 0;
+
+    // Analysis thread -> readers
+    std::atomic<juce::uint64> packedSnapshot { 0 };
+
+    // Analysis thread -> audio thread
+    static constexpr int maxQueuedChanges = 64;
+    juce::AbstractFifo changeFifo { maxQueuedChanges };
+    std::array<ChordChange, maxQueuedChanges> changes;
+    int lastQueuedChord = -2;                   // analysis thread only
+
+    // Analysis thread -> message thread; columns are dropped while nobody reads them
+    static constexpr int maxDisplayColumns = 256;
+    std::atomic<bool> displayEnabled { false };
+    juce::AbstractFifo displayFifo { maxDisplayColumns };
+    std::vector<DisplayColumn> displayColumns;
+    std::array<int, DisplayColumn::numBands + 1> bandEdges {};     // FFT bin where each band starts
+    std::atomic<juce::int64> framesAnalysed { 0 }, framesSkipped { 0 }, samplesDropped { 0 };
+    std::atomic<double> latencyMs { 0.0 }, maxLatencyMs { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LiveChordDetector)
+};
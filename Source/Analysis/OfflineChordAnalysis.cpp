@@ -0,0 +1,472 @@
+/*
+  ==============================================================================
+
+    OfflineChordAnalysis.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineChordAnalysis.h"
+#include "AudioFileReaders.h"
+#include "BeatTracker.h"
+#include "ChordAnalyzer.h"
+#include "ChordDetection.h"
+#include "ChordSmoother.h"
+#include "ChordTemplates.h"
+#include "Instrumentation.h"
+#include "OnsetDetector.h"
+#include "StreamingFrameSource.h"
+#include <algorithm>
+#include <limits>
+
+//==============================================================================
+class OfflineChordAnalysis::Job  : public juce::ThreadPoolJob
+{
+public:
+    Job(OfflineChordAnalysis& o, int index, int count)
+        : juce::ThreadPoolJob("Chord analysis: " + o.file.getFileName()), chunkIndex(index), numChunks(count), owner(o)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        owner.run(*this);
+        owner.jobFinished();
+        return jobHasFinished;
+    }
+
+    const int chunkIndex, numChunks;
+
+    // Frames [firstFrame, firstFrame + framesDone) of this chunk are complete.
+    // numFrames stays -1 until the job has opened its reader.
+    std::atomic<int> firstFrame { 0 }, numFrames { -1 }, framesDone { 0 };
+
+private:
+    OfflineChordAnalysis& owner;
+};
+
+//==============================================================================
+OfflineChordAnalysis::OfflineChordAnalysis(const juce::File& fileToAnalyse, const AnalysisSettings& settingsToUse)
+    : file(fileToAnalyse), settings(settingsToUse.isValid() ? settingsToUse : AnalysisSettings())
+{
+}
+
+OfflineChordAnalysis::~OfflineChordAnalysis()
+{
+    cancel();
+
+    for (auto& job : jobs)
+    {
+        if (client != nullptr)
+            client->removeJob(job.get(), true, -1);
+        else
+            pool->removeJob(job.get(), true, -1);
+    }
+}
+
+void OfflineChordAnalysis::start(SharedAnalysisService::Client& clientToUse, int numChunks)
+{
+    client = &clientToUse;
+    createJobs(numChunks);
+
+    for (auto& job : jobs)
+        client->addJob(job.get());
+}
+
+void OfflineChordAnalysis::start(juce::ThreadPool& poolToUse, int numChunks)
+{
+    pool = &poolToUse;
+    createJobs(numChunks);
+
+    for (auto& job : jobs)
+        pool->addJob(job.get(), false);
+}
+
+void OfflineChordAnalysis::createJobs(int numChunks)
+{
+    jassert(jobs.empty());
+
+    numChunks = juce::jmax(1, numChunks);
+    jobsRunning.store(numChunks);
+    chunksLeft.store(numChunks);
+
+    for (int i = 0; i < numChunks; ++i)
+        jobs.push_back(std::make_unique<Job>(*this, i, numChunks));
+}
+
+juce::String OfflineChordAnalysis::getParameterSignature(const AnalysisSettings& s)
+{
+    return "fft=" + juce::String(s.fftOrder)
+         + ";frame=" + juce::String(s.frameOrder)
+         + ";step=" + (s.beatSync ? "onsets" + juce::String(AnalysisSettings::onsetFrameSize) : s.hopSeconds > 0.0 ? juce::String(s.hopSeconds) + "s" : juce::String("half"))
+         + (s.chroma == AnalysisSettings::Chroma::constantQ ? ";window=cq;chroma=cq" : ";window=hann;chroma=peaks")
+         + (s.smoothing ? ";smooth=viterbi" + juce::String(ChordSmoother::defaultLagFrames) : juce::String())
+         + (s.beatSync ? ";beats=" + (s.tempoBpm > 0.0 ? juce::String(s.tempoBpm) + "bpm" : juce::String("auto")) : juce::String())
+         + ";templates=" + juce::String::toHexString((juce::int64) ChordTemplates::getDictionaryHash());
+}
+
+void OfflineChordAnalysis::jobFinished()
+{
+    // Whichever chunk finishes last finishes the beats and reports completion,
+    // before isFinished() can turn true
+    if (chunksLeft.fetch_sub(1, std::memory_order_acq_rel) == 1
+         && ! cancelled.load() && ! openFailed.load()
+         && getNumFramesAnalysed() == totalFrames.load())
+    {
+        if (settings.beatSync)
+            matchBeats();
+
+        if (onComplete != nullptr)
+            onComplete(*this);
+    }
+
+    jobsRunning.fetch_sub(1, std::memory_order_release);
+}
+
+void OfflineChordAnalysis::cancel()
+{
+    cancelled.store(true);
+
+    for (auto& job : jobs)
+        job->signalJobShouldExit();
+}
+
+double OfflineChordAnalysis::getProgress() const noexcept
+{
+    const auto total = totalFrames.load(std::memory_order_acquire);
+    if (total <= 0)
+        return 0.0;
+
+    int done = 0;
+    for (auto& job : jobs)
+        done += job->framesDone.load(std::memory_order_relaxed);
+
+    return (double) done / total;
+}
+
+int OfflineChordAnalysis::getNumFramesReady() const noexcept
+{
+    return settings.beatSync ? numBeats.load(std::memory_order_acquire) : getNumFramesAnalysed();
+}
+
+int OfflineChordAnalysis::getFrameIndexAt(juce::int64 samplePosition) const noexcept
+{
+    // With beatSync, frames isn't even sized before any are ready
+    const int numReady = getNumFramesReady();
+
+    if (numReady == 0)
+        return -1;
+
+    const auto first = frames.begin();
+    const auto end = first + numReady;
+    const auto after = std::upper_bound(first, end, samplePosition,
+                                        [] (juce::int64 position, const Frame& frame)  { return position < frame.position; });
+
+    return (int) (after - first) - 1;
+}
+
+int OfflineChordAnalysis::getNumFramesAnalysed() const noexcept
+{
+    int ready = 0;
+
+    for (auto& job : jobs)
+    {
+        const auto chunkSize = job->numFrames.load(std::memory_order_relaxed);
+        const auto done = job->framesDone.load(std::memory_order_acquire);
+        ready += done;
+
+        if (chunkSize < 0 || done < chunkSize)
+            break;
+    }
+
+    return ready;
+}
+
+void OfflineChordAnalysis::allocateFrames(const juce::AudioFormatReader& reader)
+{
+    stepSize = settings.getHopSize(reader.sampleRate);
+
+    const auto frameSize = settings.getFrameSize();
+    const auto length = reader.lengthInSamples;
+    const int numFrames = length >= frameSize && stepSize > 0 ? (int) ((length - frameSize) / stepSize) + 1 : 0;
+
+    // Beat-synchronous results are sized once the beats are known
+    if (settings.beatSync)
+    {
+        chromaInterval = juce::jmax(1, frameSize / stepSize);
+        frameProfiles.resize((size_t) ((numFrames + chromaInterval - 1) / chromaInterval) * 12);
+        onsetStrengths.resize((size_t) numFrames);
+    }
+    else
+    {
+        frames.resize((size_t) numFrames);
+    }
+
+    sampleRate.store(reader.sampleRate);
+    totalFrames.store(numFrames, std::memory_order_release);
+}
+
+void OfflineChordAnalysis::run(Job& thisJob)
+{
+    // Each job gets its own reader: the player's reader belongs to its stream.
+    // WAV/AIFF are memory-mapped, so every chunk reads straight from the same pages.
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    auto reader = AudioFileReaders::createReaderFor(formatManager, file);
+
+    if (reader == nullptr)
+    {
+        openFailed.store(true);
+        return;
+    }
+
+    std::call_once(framesAllocated, [&] { allocateFrames(*reader); });
+
+    // This chunk's share of the frames. Its last frame reads up to a frame
+    // size past the start of the next chunk, so chunks overlap by one frame.
+    const int numFrames = totalFrames.load();
+    const int firstFrame = (int) ((juce::int64) numFrames * thisJob.chunkIndex / thisJob.numChunks);
+    const int endFrame = (int) ((juce::int64) numFrames * (thisJob.chunkIndex + 1) / thisJob.numChunks);
+
+    thisJob.firstFrame.store(firstFrame);
+    thisJob.numFrames.store(endFrame - firstFrame);
+
+    // With smoothing, the decoder also runs over a lag's worth of frames on
+    // either side of the chunk, so the frames near its edges are decided with
+    // the same context they would have in one long run. Per-beat smoothing
+    // happens later, so then a chunk only needs the frame before it, for its
+    // first frame's spectral flux.
+    const bool smoothFrames = settings.smoothing && ! settings.beatSync;
+    const int contextFrames = smoothFrames ? ChordSmoother::defaultLagFrames : 0;
+    const int startFrame = juce::jmax(0, firstFrame - (settings.beatSync ? 1 : contextFrames));
+    const int stopFrame = juce::jmin(numFrames, endFrame + contextFrames);
+
+    // Decodes the chunk once, front to back, one frame at a time
+    StreamingFrameSource frameSource(*reader, settings.getFrameSize(), stepSize);
+    frameSource.reset((juce::int64) startFrame * stepSize);
+
+    ChordAnalyzer analyzer;
+    analyzer.prepare(reader->sampleRate, settings);
+
+    OnsetDetector onsetDetector;
+
+    ChordSmoother smoother;
+    std::vector<float> scores;
+    std::vector<ChordSmoother::Decision> lastDecisions;
+
+    if (smoothFrames)
+    {
+        smoother.prepare(contextFrames);
+        scores.resize((size_t) ChordSmoother::numChords);
+        lastDecisions.resize((size_t) contextFrames);
+    }
+
+    // Decisions arrive in frame order; only this chunk's own frames are kept
+    int decidedFrame = startFrame;
+
+    auto storeDecision = [&] (const ChordSmoother::Decision& decision)
+    {
+        const int frameIndex = decidedFrame++;
+
+        if (frameIndex < firstFrame || frameIndex >= endFrame)
+            return;
+
+        auto& result = frames[(size_t) frameIndex];
+        result.chordIndex = decision.chordIndex;
+        result.score = decision.score;
+
+        thisJob.framesDone.store(frameIndex + 1 - firstFrame, std::memory_order_release);
+    };
+
+    // Iterate through the chunk in steps of stepSize
+    for (int frameIndex = startFrame; frameIndex < stopFrame; ++frameIndex)
+    {
+        if (thisJob.shouldExit())
+            return;
+
+        VST_SAMPLER_SCOPED_STAGE (frame);
+
+        // Read the next frame from the file (mono files are copied to both channels)
+        {
+            VST_SAMPLER_SCOPED_STAGE (frameRead);
+
+            if (! frameSource.readNextFrame())
+                break;
+        }
+
+        const juce::int64 position = frameSource.getFramePosition();
+        jassert(position == (juce::int64) frameIndex * stepSize);
+
+        // The onset strength from the start of every frame, and window, FFT and
+        // PCP for every chromaInterval'th; chords are matched per beat once
+        // every chunk is done
+        if (settings.beatSync)
+        {
+            float strength;
+            {
+                VST_SAMPLER_SCOPED_STAGE (onset);
+                strength = onsetDetector.process(frameSource.getFrame(), frameSource.getNumChannels());
+            }
+
+            if (frameIndex >= firstFrame)
+            {
+                if (frameIndex % chromaInterval == 0)
+                {
+                    analyzer.computePitchClassProfile(frameSource.getFrame(), frameSource.getNumChannels());
+                    std::copy_n(analyzer.getPitchClassProfile(), 12,
+                                frameProfiles.begin() + (std::ptrdiff_t) (frameIndex / chromaInterval) * 12);
+                }
+
+                onsetStrengths[(size_t) frameIndex] = strength;
+                thisJob.framesDone.store(frameIndex + 1 - firstFrame, std::memory_order_release);
+            }
+
+            continue;
+        }
+
+        // Window, FFT, PCP and template match
+        const auto analysed = analyzer.analyseFrame(frameSource.getFrame(), frameSource.getNumChannels());
+
+        if (frameIndex >= firstFrame && frameIndex < endFrame)
+            frames[(size_t) frameIndex].position = position;
+
+        if (smoothFrames)
+        {
+            const bool heard = ChordDetection::scoreChords(analyzer.getPitchClassProfile(), scores.data());
+
+            ChordSmoother::Decision decision;
+            if (smoother.push(heard ? scores.data() : nullptr, decision))
+                storeDecision(decision);
+        }
+        else
+        {
+            storeDecision({ analysed.chordIndex, analysed.score });
+        }
+    }
+
+    if (smoothFrames)
+    {
+        const int numLeft = smoother.flush(lastDecisions.data());
+
+        for (int i = 0; i < numLeft; ++i)
+            storeDecision(lastDecisions[(size_t) i]);
+    }
+}
+
+void OfflineChordAnalysis::matchBeats()
+{
+    VST_SAMPLER_SCOPED_STAGE (beats);
+
+    const int numFrames = totalFrames.load();
+
+    if (numFrames == 0)
+        return;
+
+    const auto framesPerSecond = getSampleRate() / stepSize;
+    const auto bpm = settings.tempoBpm > 0.0 ? settings.tempoBpm
+                                             : BeatTracker::estimateTempo(onsetStrengths.data(), numFrames, framesPerSecond);
+
+    auto beats = BeatTracker::trackBeats(onsetStrengths.data(), numFrames, framesPerSecond, bpm);
+
+    // Whatever comes before the first beat is a segment of its own
+    if (beats.empty() || beats.front() > 0)
+        beats.insert(beats.begin(), 0);
+
+    const int count = (int) beats.size();
+    constexpr int numChords = ChordSmoother::numChords;
+    std::vector<float> profiles((size_t) count * 12, 0.0f), scores;
+    std::vector<int> path;
+
+    // The flux peaks while an onset is still in the window's leading edge,
+    // about three quarters of the way into the onset frame. That is where each
+    // beat (but the first) starts, both for grouping the chroma and in the results.
+    const auto onsetOffset = (juce::int64) AnalysisSettings::onsetFrameSize * 3 / 4;
+    std::vector<juce::int64> starts((size_t) count + 1);
+
+    for (int beat = 0; beat < count; ++beat)
+        starts[(size_t) beat] = beats[(size_t) beat] > 0 ? (juce::int64) beats[(size_t) beat] * stepSize + onsetOffset : 0;
+
+    starts[(size_t) count] = std::numeric_limits<juce::int64>::max();
+
+    // Each beat hears the chroma frames centred between its start and the next
+    // beat's. A beat shorter than a chroma frame may have none, and then hears
+    // the one around its middle.
+    const int numChromaFrames = (int) frameProfiles.size() / 12;
+    const auto chromaHop = (juce::int64) chromaInterval * stepSize;
+    const auto toCentre = (juce::int64) settings.getFrameSize() / 2;
+
+    auto firstCentredFrom = [&] (juce::int64 position)
+    {
+        if (position <= toCentre)
+            return 0;
+
+        return (int) juce::jmin((juce::int64) numChromaFrames, (position - toCentre + chromaHop - 1) / chromaHop);
+    };
+
+    for (int beat = 0; beat < count; ++beat)
+    {
+        const auto start = starts[(size_t) beat], end = starts[(size_t) beat + 1];
+        const int firstChroma = firstCentredFrom(start);
+        const int endChroma = juce::jmax(firstChroma, firstCentredFrom(end));
+        auto* profile = profiles.data() + (size_t) beat * 12;
+
+        if (firstChroma == endChroma)
+        {
+            const auto middle = start + (juce::jmin(end, (juce::int64) numFrames * stepSize) - start) / 2;
+            const int around = (int) juce::jlimit((juce::int64) 0, (juce::int64) numChromaFrames - 1, (middle - toCentre) / chromaHop);
+            juce::FloatVectorOperations::copy(profile, frameProfiles.data() + (size_t) around * 12, 12);
+        }
+
+        for (int chroma = firstChroma; chroma < endChroma; ++chroma)
+            juce::FloatVectorOperations::add(profile, frameProfiles.data() + (size_t) chroma * 12, 12);
+    }
+
+    if (settings.smoothing)
+    {
+        scores.resize((size_t) count * numChords);
+        path.resize((size_t) count);
+
+        for (int beat = 0; beat < count; ++beat)
+            ChordDetection::scoreChords(profiles.data() + (size_t) beat * 12, scores.data() + (size_t) beat * numChords);
+
+        ChordSmoother::decode(scores.data(), count, path.data());
+    }
+
+    frames.resize((size_t) count);
+
+    for (int beat = 0; beat < count; ++beat)
+    {
+        auto& result = frames[(size_t) beat];
+
+        result.position = starts[(size_t) beat];
+
+        if (settings.smoothing)
+        {
+            result.chordIndex = path[(size_t) beat];
+            result.score = result.chordIndex >= 0 ? scores[(size_t) beat * numChords + (size_t) result.chordIndex] : 0.0f;
+        }
+        else
+        {
+            result.chordIndex = ChordDetection::matchChord(profiles.data() + (size_t) beat * 12, &result.score);
+        }
+    }
+
+    tempo.store(bpm);
+    numBeats.store(count, std::memory_order_release);
+}
+
+std::unique_ptr<ChordTimeline> OfflineChordAnalysis::createTimeline() const
+{
+    return createTimeline(frames.data(), getNumFramesReady(), getSampleRate());
+}
+
+std::unique_ptr<ChordTimeline> OfflineChordAnalysis::createTimeline(const Frame* framesToAdd, int numFrames, double rate)
+{
+    ChordTimeline::Builder builder(rate);
+
+    for (int i = 0; i < numFrames; ++i)
+        builder.addFrame(framesToAdd[i].position, framesToAdd[i].chordIndex, framesToAdd[i].score);
+
+    return builder.build();
+}
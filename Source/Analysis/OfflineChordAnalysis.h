@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    OfflineChordAnalysis.h
+
+    Runs the "Chord ID" pass over a whole file on background jobs, on the
+    plugin's SharedAnalysisService or a juce::ThreadPool of the caller's.
+    The file's frames are split into contiguous chunks, one job per chunk, and
+    each job opens its own reader (readers can't be shared between threads, and
+    the player's stream must not be touched at all). Every frame is
+    analysed independently, so the result doesn't depend on the chunk count.
+    With smoothing on, each chunk runs a fixed-lag ChordSmoother that also
+    reads a lag's worth of frames beyond both of its ends, so the chunk
+    edges see (nearly) the context a single run would.
+
+    Frames are published as they complete and can be read, in order, while
+    the jobs are still running.
+
+    With AnalysisSettings::beatSync the frames step by half an onset frame.
+    The jobs keep every frame's onset strength, and a pitch class profile
+    for every frame that starts a whole frame size after the last one, so
+    the chroma frames don't overlap. Whichever job finishes last tracks the
+    beats over the whole onset envelope (BeatTracker), sums the profiles
+    between consecutive beats, and matches and smooths once per beat. The
+    results are then one per beat, and none are ready until that is done.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalysisSettings.h"
+#include "ChordTimeline.h"
+#include "SharedAnalysisService.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class OfflineChordAnalysis
+{
+public:
+    struct Frame
+    {
+        juce::int64 position = 0;   // first sample of the frame (or the beat) in the file
+        int chordIndex = -1;
+        float score = 0.0f;
+    };
+
+    explicit OfflineChordAnalysis(const juce::File& fileToAnalyse, const AnalysisSettings& settings = {});
+
+    /** Cancels the job if it is still running and waits for it to stop. */
+    ~OfflineChordAnalysis();
+
+    /** Splits the file into numChunks chunks and queues one job per chunk,
+        either on the shared service at the client's priority or on a pool of
+        the caller's own. It needs at least that many threads to run them all
+        at once.
+    */
+    void start(SharedAnalysisService::Client& clientToUse, int numChunks = 1);
+    void start(juce::ThreadPool& poolToUse, int numChunks = 1);
+
+    /** Called on a worker thread once every frame has been analysed. Not
+        called if the analysis was cancelled or the file couldn't be read.
+        Set it before calling start().
+    */
+    std::function<void(const OfflineChordAnalysis&)> onComplete;
+
+    /** Identifies the analysis settings (FFT and frame size, step, window,
+        chroma, smoothing and template set), for keying cached results.
+    */
+    static juce::String getParameterSignature(const AnalysisSettings&);
+
+    /** Asks the jobs to stop after their current frame. Returns immediately. */
+    void cancel();
+
+    const juce::File& getFile() const noexcept          { return file; }
+    const AnalysisSettings& getSettings() const noexcept { return settings; }
+
+    /** True once all jobs have stopped, whether they completed, failed or were cancelled. */
+    bool isFinished() const noexcept                    { return jobsRunning.load(std::memory_order_acquire) == 0; }
+    bool wasCancelled() const noexcept                  { return cancelled.load(); }
+    bool failedToOpen() const noexcept                  { return openFailed.load(); }
+
+    double getProgress() const noexcept;
+    double getSampleRate() const noexcept               { return sampleRate.load(); }
+    int getStepSize() const noexcept                    { return stepSize; }
+
+    /** The number of STFT frames, stepSize apart. Results are one per frame
+        except with beatSync, where they are one per beat.
+    */
+    int getTotalFrames() const noexcept                 { return totalFrames.load(std::memory_order_acquire); }
+
+    /** Frames [0, getNumFramesReady()) are complete and won't change.
+        Later chunks may have finished more, but they are only counted once
+        everything before them is done.
+    */
+    int getNumFramesReady() const noexcept;
+    const Frame& getFrame(int index) const noexcept     { return frames[(size_t) index]; }
+
+    /** The last ready frame starting at or before the sample position, or -1. */
+    int getFrameIndexAt(juce::int64 samplePosition) const noexcept;
+
+    /** The tempo the beats were tracked at, once they have been; 0 without beatSync. */
+    double getTempo() const noexcept                    { return tempo.load(); }
+
+    /** Merges the frames that are ready so far into a timeline. */
+    std::unique_ptr<ChordTimeline> createTimeline() const;
+
+    static std::unique_ptr<ChordTimeline> createTimeline(const Frame* frames, int numFrames, double sampleRate);
+
+private:
+    class Job;
+    void run(Job&);
+    void jobFinished();
+    void allocateFrames(const juce::AudioFormatReader&);
+    void createJobs(int numChunks);
+    int getNumFramesAnalysed() const noexcept;
+    void matchBeats();
+
+    const juce::File file;
+    const AnalysisSettings settings;
+    SharedAnalysisService::Client* client = nullptr;    // whichever start() was given
+    juce::ThreadPool* pool = nullptr;
+    std::vector<std::unique_ptr<Job>> jobs;
+
+    // Sized once by whichever job opens its reader first
+    std::once_flag framesAllocated;
+    std::vector<Frame> frames;
+    int stepSize = 0;
+
+    // With beatSync: an onset strength per frame, and 12 profile values per
+    // chromaInterval frames
+    std::vector<float> frameProfiles, onsetStrengths;
+    int chromaInterval = 1;
+
+    // jobsRunning only reaches 0 once the last job has finished reporting
+    std::atomic<int> totalFrames { 0 }, jobsRunning { 0 }, chunksLeft { 0 }, numBeats { 0 };
+    std::atomic<double> sampleRate { 0.0 }, tempo { 0.0 };
+    std::atomic<bool> cancelled { false }, openFailed { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineChordAnalysis)
+};
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    OnsetDetector.cpp
+
+  ==============================================================================
+*/
+
+#include "OnsetDetector.h"
+
+OnsetDetector::OnsetDetector()
+{
+    for (int i = 0; i < fftSize; ++i)
+        window[(size_t) i] = 0.5f * (1 - std::cos((2 * juce::MathConstants<float>::pi * i) / (fftSize - 1)));
+}
+
+void OnsetDetector::reset() noexcept
+{
+    hasPrevious = false;
+}
+
+float OnsetDetector::process(const float* const* channels, int numChannels) noexcept
+{
+    float* data = fftData.data();
+
+    // Mix down and sum each group of samples, a crude low-pass at a quarter of
+    // the rate, then window and leave the FFT's working half zeroed
+    {
+        juce::FloatVectorOperations::clear(data, 2 * fftSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* samples = channels[channel];
+
+            for (int i = 0; i < fftSize; ++i)
+                for (int k = 0; k < decimation; ++k)
+                    data[i] += samples[decimation * i + k];
+        }
+
+        juce::FloatVectorOperations::multiply(data, window.data(), fftSize);
+    }
+
+    fft.performFrequencyOnlyForwardTransform(data);
+
+    const float scale = compression / (float) (numBins * decimation);
+    float* logMagnitudes = current.data();
+
+    for (int bin = 0; bin < numBins; ++bin)
+        logMagnitudes[bin] = std::log1p(scale * data[bin]);
+
+    float flux = 0.0f;
+
+    if (hasPrevious)
+        for (int bin = 0; bin < numBins; ++bin)
+            flux += juce::jmax(0.0f, logMagnitudes[bin] - previous[(size_t) bin]);
+
+    std::swap(previous, current);
+    hasPrevious = true;
+    return flux;
+}
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    OnsetDetector.h
+
+    Onset strength by spectral flux: how much the log-compressed magnitude
+    spectrum rose since the previous frame, summed over the bins (falls are
+    ignored).
+
+    It runs on short frames of its own, AnalysisSettings::onsetFrameSize
+    samples (about 23 ms at 44.1 kHz). Each frame is mixed to mono and
+    summed in fours down to a quarter of the rate (Ellis tracks beats at
+    8 kHz), then goes through a Hann window and a 256-point FFT. Onsets show
+    in the spectral envelope more than in the top octaves, and a frame costs
+    a small fraction of a chroma frame. So the envelope can run at a much
+    finer hop than the chroma does.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalysisSettings.h"
+#include <array>
+
+class OnsetDetector
+{
+public:
+    OnsetDetector();
+
+    /** Forgets the previous frame, so the next one scores 0. */
+    void reset() noexcept;
+
+    /** Sums the first AnalysisSettings::onsetFrameSize samples of each channel
+        and returns the frame's onset strength (0 or more). Allocation-free.
+    */
+    float process(const float* const* channels, int numChannels) noexcept;
+
+    // Magnitudes (relative to the bin count) are compressed as log(1 + compression * x)
+    static constexpr float compression = 1000.0f;
+
+private:
+    static constexpr int fftOrder = 8;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2;
+    static constexpr int decimation = AnalysisSettings::onsetFrameSize / fftSize;   // frame samples per FFT input
+
+    juce::dsp::FFT fft { fftOrder };
+    std::array<float, fftSize> window {};
+    std::array<float, 2 * fftSize> fftData {};
+    std::array<float, numBins> previous {}, current {};
+    bool hasPrevious = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OnsetDetector)
+};
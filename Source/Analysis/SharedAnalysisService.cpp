@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    SharedAnalysisService.cpp
+
+  ==============================================================================
+*/
+
+#include "SharedAnalysisService.h"
+#include <algorithm>
+
+//==============================================================================
+// Queued once per added job; runs whichever job is best when it gets a thread
+class SharedAnalysisService::Dispatcher  : public juce::ThreadPoolJob
+{
+public:
+    explicit Dispatcher(SharedAnalysisService& s)
+        : juce::ThreadPoolJob("Analysis dispatcher"), service(s)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        service.runNextJob();
+        return jobHasFinished;
+    }
+
+private:
+    SharedAnalysisService& service;
+};
+
+//==============================================================================
+SharedAnalysisService::SharedAnalysisService()
+    : pool(juce::jmax(1, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+SharedAnalysisService::~SharedAnalysisService()
+{
+    // Every client holds a reference, so they have all gone and taken their jobs with them
+    jassert(waiting.empty() && running.empty());
+    pool.removeAllJobs(true, -1);
+}
+
+SharedAnalysisService::Client::~Client()
+{
+    service->removeAllJobs(*this);
+}
+
+//==============================================================================
+void SharedAnalysisService::addJob(Client& client, juce::ThreadPoolJob* job)
+{
+    jassert(job != nullptr);
+
+    {
+        const juce::ScopedLock sl(lock);
+        waiting.push_back({ &client, job });
+    }
+
+    pool.addJob(new Dispatcher(*this), true);
+}
+
+bool SharedAnalysisService::removeJob(juce::ThreadPoolJob* job, bool interruptIfRunning, int timeOutMs)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        auto matches = [job] (const QueuedJob& q)   { return q.job == job; };
+
+        // Its dispatcher will find something else to run, or nothing
+        const auto it = std::find_if(waiting.begin(), waiting.end(), matches);
+
+        if (it != waiting.end())
+        {
+            waiting.erase(it);
+            return true;
+        }
+
+        if (std::none_of(running.begin(), running.end(), matches))
+            return true;
+
+        if (interruptIfRunning)
+            job->signalJobShouldExit();
+    }
+
+    const auto startTime = juce::Time::getMillisecondCounter();
+
+    while (isRunning(job))
+    {
+        if (timeOutMs >= 0 && juce::Time::getMillisecondCounter() >= startTime + (juce::uint32) timeOutMs)
+            return false;
+
+        // Only one waiter wakes per signal, so the rest poll
+        jobFinished.wait(10);
+    }
+
+    return true;
+}
+
+void SharedAnalysisService::removeAllJobs(Client& client)
+{
+    std::vector<juce::ThreadPoolJob*> toWaitFor;
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        waiting.erase(std::remove_if(waiting.begin(), waiting.end(),
+                                     [&client] (const QueuedJob& q)  { return q.client == &client; }),
+                      waiting.end());
+
+        for (auto& q : running)
+            if (q.client == &client)
+                toWaitFor.push_back(q.job);
+    }
+
+    for (auto* job : toWaitFor)
+        removeJob(job, true, -1);
+}
+
+bool SharedAnalysisService::isRunning(const juce::ThreadPoolJob* job) const
+{
+    const juce::ScopedLock sl(lock);
+    return std::any_of(running.begin(), running.end(), [job] (const QueuedJob& q)  { return q.job == job; });
+}
+
+void SharedAnalysisService::runNextJob()
+{
+    QueuedJob next;
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        // Highest priority, then the client that has waited longest; ties keep the order they were added in
+        auto isBetter = [] (const QueuedJob& a, const QueuedJob& b)
+        {
+            const auto priorityA = a.client->getPriority(), priorityB = b.client->getPriority();
+
+            if (priorityA != priorityB)
+                return priorityA > priorityB;
+
+            return a.client->lastServed < b.client->lastServed;
+        };
+
+        auto best = waiting.begin();
+
+        for (auto it = waiting.begin(); it != waiting.end(); ++it)
+            if (isBetter(*it, *best))
+                best = it;
+
+        if (best == waiting.end())
+            return;
+
+        next = *best;
+        waiting.erase(best);
+        next.client->lastServed = ++numDispatched;
+        running.push_back(next);
+    }
+
+    const auto status = next.job->runJob();
+
+    {
+        const juce::ScopedLock sl(lock);
+        running.erase(std::find_if(running.begin(), running.end(), [&next] (const QueuedJob& q)  { return q.job == next.job; }));
+
+        if (status == juce::ThreadPoolJob::jobNeedsRunningAgain && ! next.job->shouldExit())
+            waiting.push_back(next);
+        else
+            next.job = nullptr;
+    }
+
+    jobFinished.signal();
+
+    if (next.job != nullptr)
+        pool.addJob(new Dispatcher(*this), true);
+}
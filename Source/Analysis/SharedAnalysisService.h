@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    SharedAnalysisService.h
+
+    One pool of offline analysis threads for every plugin instance in the
+    process, reached through a juce::SharedResourcePointer. Left to
+    themselves, a dozen instances would start a dozen pools of one thread
+    per core and fight over the machine; this pool keeps one thread per core
+    (less one for the audio and message threads) however many instances
+    there are.
+
+    Each instance talks to it through its own Client, which carries the
+    instance's priority. Jobs aren't queued in the juce::ThreadPool in the
+    order they were added: every added job only queues a dispatcher, and
+    whichever dispatcher gets a thread runs the best job waiting at that
+    moment. That is the highest priority first and, between equal
+    priorities, the client served least recently, so one instance's many
+    chunks can't starve another's. The jobs themselves are ordinary
+    juce::ThreadPoolJobs, added and removed as they would be on a ThreadPool.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+class SharedAnalysisService
+{
+public:
+    /** Higher runs first. */
+    enum class Priority
+    {
+        background,
+        visible,    // the instance's editor is open
+        playing     // the instance is playing its file
+    };
+
+    SharedAnalysisService();
+    ~SharedAnalysisService();
+
+    int getNumThreads() const noexcept      { return pool.getNumThreads(); }
+
+    //==============================================================================
+    /** One plugin instance's handle on the service. Holding one keeps the service alive. */
+    class Client
+    {
+    public:
+        Client() = default;
+
+        /** Removes any jobs still waiting and waits for its running ones to finish. */
+        ~Client();
+
+        void setPriority(Priority newPriority) noexcept     { priority.store(newPriority); }
+        Priority getPriority() const noexcept               { return priority.load(); }
+
+        /** Queues a job. It isn't owned, and must stay alive until it has
+            finished or removeJob() has returned true for it.
+        */
+        void addJob(juce::ThreadPoolJob* job)               { service->addJob(*this, job); }
+
+        /** As juce::ThreadPool::removeJob(): a waiting job is dropped, a running
+            one is optionally asked to stop and waited for. Returns false if it
+            was still running after timeOutMs (-1 waits for ever).
+        */
+        bool removeJob(juce::ThreadPoolJob* job, bool interruptIfRunning, int timeOutMs)
+        {
+            return service->removeJob(job, interruptIfRunning, timeOutMs);
+        }
+
+        int getNumThreads() const noexcept                  { return service->getNumThreads(); }
+
+    private:
+        friend class SharedAnalysisService;
+
+        juce::SharedResourcePointer<SharedAnalysisService> service;
+        std::atomic<Priority> priority { Priority::background };
+        juce::uint64 lastServed = 0;    // guarded by the service's lock
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Client)
+    };
+
+private:
+    class Dispatcher;
+
+    struct QueuedJob
+    {
+        Client* client;
+        juce::ThreadPoolJob* job;
+    };
+
+    void addJob(Client&, juce::ThreadPoolJob*);
+    bool removeJob(juce::ThreadPoolJob*, bool interruptIfRunning, int timeOutMs);
+    void removeAllJobs(Client&);
+    void runNextJob();
+    bool isRunning(const juce::ThreadPoolJob*) const;
+
+    juce::CriticalSection lock;
+    std::vector<QueuedJob> waiting, running;
+    juce::uint64 numDispatched = 0;
+    juce::WaitableEvent jobFinished;
+
+    juce::ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedAnalysisService)
+};
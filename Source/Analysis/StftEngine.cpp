@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    StftEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "StftEngine.h"
+
+namespace
+{
+    using Factory = std::unique_ptr<StftEngineBase> (*)();
+
+    template <int FftOrder, int FrameOrder>
+    std::unique_ptr<StftEngineBase> createEngine()
+    {
+        return std::make_unique<StftEngine<FftOrder, FrameOrder>>();
+    }
+
+    constexpr int numOrders = AnalysisSettings::maxOrder - AnalysisSettings::minOrder + 1;
+    static_assert(numOrders == 5, "Update the factory table below when the range of orders changes");
+
+    // [fftOrder - minOrder][frameOrder - minOrder]; frames longer than the FFT have no engine
+    const Factory factories[numOrders][numOrders] =
+    {
+        { createEngine<10, 10>, nullptr,              nullptr,              nullptr,              nullptr },
+        { createEngine<11, 10>, createEngine<11, 11>, nullptr,              nullptr,              nullptr },
+        { createEngine<12, 10>, createEngine<12, 11>, createEngine<12, 12>, nullptr,              nullptr },
+        { createEngine<13, 10>, createEngine<13, 11>, createEngine<13, 12>, createEngine<13, 13>, nullptr },
+        { createEngine<14, 10>, createEngine<14, 11>, createEngine<14, 12>, createEngine<14, 13>, createEngine<14, 14> }
+    };
+}
+
+std::unique_ptr<StftEngineBase> StftEngineBase::create(int fftOrder, int frameOrder)
+{
+    const auto fftIndex = fftOrder - AnalysisSettings::minOrder;
+    const auto frameIndex = frameOrder - AnalysisSettings::minOrder;
+
+    if (! juce::isPositiveAndBelow(fftIndex, numOrders) || ! juce::isPositiveAndBelow(frameIndex, numOrders))
+        return {};
+
+    if (auto factory = factories[fftIndex][frameIndex])
+        return factory();
+
+    return {};
+}
@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    StftEngine.h
+
+    The per-frame analysis (window, FFT, chroma, template match), compiled
+    separately for each FFT size and frame size. With both known at compile
+    time, every buffer is a fixed-size array inside the engine, the window is
+    a table built once per instantiation and shared by all its instances, and
+    the loops have constant trip counts.
+
+    Frames shorter than the FFT are zero-padded, which is how the low-latency
+    preset keeps a short window without losing frequency-bin density.
+
+    The chroma stage is either ChromaMapper's peak picking on the magnitude
+    spectrum, or ConstantQChroma's sparse kernel on the complex spectrum. The
+    constant-Q kernels carry their own windows, so that path skips the Hann
+    window and keeps the FFT's phases. Both stages' tables are read-only once
+    built, so every engine in the process with the same sample rate and
+    sizes shares one copy, as it does the window and ChordTemplates'
+    compile-time dictionary. The FFT object and the buffers are the engine's
+    own: JUCE's FFT engines lock or keep scratch inside the object, so a
+    shared one would serialise the threads using it.
+
+    StftEngineBase::create() picks the instantiation at runtime; ChordAnalyzer
+    wraps that, so most code never sees the template.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalysisSettings.h"
+#include "ChordDetection.h"
+#include "ChromaMapper.h"
+#include "ConstantQChroma.h"
+#include "Instrumentation.h"
+#include <array>
+#include <memory>
+
+class StftEngineBase
+{
+public:
+    struct Result
+    {
+        int chordIndex = -1;
+        float score = 0.0f;
+    };
+
+    virtual ~StftEngineBase() = default;
+
+    /** Picks up the shared chroma tables for the sample rate, building them if no
+        other engine has. Does nothing if it hasn't changed.
+    */
+    virtual void prepare(double sampleRate, AnalysisSettings::Chroma) = 0;
+
+    /** Sums getFrameSize() samples from each channel and analyses them. Allocation-free. */
+    virtual Result analyseFrame(const float* const* channels, int numChannels) noexcept = 0;
+
+    /** As analyseFrame(), up to the pitch class profile: no template match. */
+    virtual void computePitchClassProfile(const float* const* channels, int numChannels) noexcept = 0;
+
+    /** The last frame's magnitude spectrum (getFftSize() / 2 bins; peak-picking chroma
+        only) and pitch class profile.
+    */
+    virtual const float* getMagnitudes() const noexcept = 0;
+    virtual const float* getPitchClassProfile() const noexcept = 0;
+
+    virtual int getFftOrder() const noexcept = 0;
+    virtual int getFrameOrder() const noexcept = 0;
+
+    /** Returns nullptr if the orders are outside AnalysisSettings::minOrder..maxOrder,
+        or the frame is longer than the FFT.
+    */
+    static std::unique_ptr<StftEngineBase> create(int fftOrder, int frameOrder);
+};
+
+//==============================================================================
+template <int FftOrder, int FrameOrder>
+class StftEngine final  : public StftEngineBase
+{
+public:
+    static_assert(FrameOrder <= FftOrder, "A frame can't be longer than the FFT");
+    static_assert(FftOrder <= AnalysisSettings::maxOrder, "JUCE's fallback FFT allocates above order 14");
+
+    static constexpr int fftSize = 1 << FftOrder;
+    static constexpr int frameSize = 1 << FrameOrder;
+    static constexpr int numBins = fftSize / 2;
+
+    StftEngine() = default;
+
+    void prepare(double sampleRate, AnalysisSettings::Chroma newChroma) override
+    {
+        chroma = newChroma;
+
+        if (chroma == AnalysisSettings::Chroma::constantQ)
+        {
+            if (constantQ == nullptr || ! constantQ->isPreparedFor(sampleRate, FftOrder, frameSize))
+                constantQ = ConstantQChroma::getShared(sampleRate, FftOrder, frameSize);
+        }
+        else
+        {
+            if (chromaMapper == nullptr || ! chromaMapper->isPreparedFor(sampleRate, FftOrder))
+                chromaMapper = ChromaMapper::getShared(sampleRate, FftOrder);
+
+            jassert(chromaMapper->getNumBins() == numBins);
+        }
+    }
+
+    Result analyseFrame(const float* const* channels, int numChannels) noexcept override
+    {
+        computePitchClassProfile(channels, numChannels);
+
+        VST_SAMPLER_SCOPED_STAGE (match);
+
+        Result result;
+        result.chordIndex = ChordDetection::matchChord(pitchClassProfile.data(), &result.score);
+        return result;
+    }
+
+    void computePitchClassProfile(const float* const* channels, int numChannels) noexcept override
+    {
+        float* data = fftData.data();
+        const bool useConstantQ = chroma == AnalysisSettings::Chroma::constantQ;
+
+        // Mix down, apply the window, then zero-pad up to the FFT size
+        {
+            VST_SAMPLER_SCOPED_STAGE (window);
+
+            juce::FloatVectorOperations::copy(data, channels[0], frameSize);
+
+            for (int channel = 1; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::add(data, channels[channel], frameSize);
+
+            if (! useConstantQ)
+                juce::FloatVectorOperations::multiply(data, getWindow().data(), frameSize);
+
+            juce::FloatVectorOperations::clear(data + frameSize, 2 * fftSize - frameSize);
+        }
+
+        // Either magnitudes in the first half, or interleaved complex bins 0..numBins
+        {
+            VST_SAMPLER_SCOPED_STAGE (fft);
+
+            if (useConstantQ)
+                fft.performRealOnlyForwardTransform(data, true);
+            else
+                fft.performFrequencyOnlyForwardTransform(data);
+        }
+
+        {
+            VST_SAMPLER_SCOPED_STAGE (chroma);
+
+            if (useConstantQ)
+                constantQ->computePitchClassProfile(data, pitchClassProfile.data());
+            else
+                chromaMapper->computePitchClassProfile(data, pitchClassProfile.data(), peakScratch.data());
+        }
+    }
+
+    const float* getMagnitudes() const noexcept override            { return fftData.data(); }
+    const float* getPitchClassProfile() const noexcept override     { return pitchClassProfile.data(); }
+    int getFftOrder() const noexcept override                       { return FftOrder; }
+    int getFrameOrder() const noexcept override                     { return FrameOrder; }
+
+    /** Hann window over the frame, built once per instantiation. */
+    static const std::array<float, frameSize>& getWindow()
+    {
+        static const std::array<float, frameSize> window = []
+        {
+            std::array<float, frameSize> w {};
+
+            for (int i = 0; i < frameSize; ++i)
+                w[(size_t) i] = 0.5f * (1 - std::cos((2 * juce::MathConstants<float>::pi * i) / (frameSize - 1)));
+
+            return w;
+        }();
+
+        return window;
+    }
+
+private:
+    juce::dsp::FFT fft { FftOrder };
+    AnalysisSettings::Chroma chroma = AnalysisSettings::Chroma::peaks;
+    std::shared_ptr<const ChromaMapper> chromaMapper;
+    std::shared_ptr<const ConstantQChroma> constantQ;
+
+    std::array<float, 2 * fftSize> fftData {};  // both transforms need twice the FFT size
+    std::array<float, numBins> peakScratch {};
+    std::array<float, 12> pitchClassProfile {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StftEngine)
+};
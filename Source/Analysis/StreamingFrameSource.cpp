@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    StreamingFrameSource.cpp
+
+  ==============================================================================
+*/
+
+#include "StreamingFrameSource.h"
+
+StreamingFrameSource::StreamingFrameSource(juce::AudioFormatReader& r, int frameSizeToUse, int hopSizeToUse, int numChannels)
+    : reader(r),
+      frameSize(frameSizeToUse),
+      hopSize(juce::jmax(1, hopSizeToUse)),
+      decodeGaps(! canSeekCheaply(r)),
+      frame(numChannels, frameSizeToUse),
+      gapScratch(numChannels, decodeGaps && hopSize > frameSize ? frameSizeToUse : 0)
+{
+}
+
+bool StreamingFrameSource::canSeekCheaply(const juce::AudioFormatReader& r)
+{
+    const auto format = r.getFormatName();
+    return format.startsWith("WAV") || format.startsWith("AIFF");
+}
+
+void StreamingFrameSource::reset(juce::int64 firstFramePosition)
+{
+    framePosition = firstFramePosition;
+    nextReadPosition = firstFramePosition;
+    hasFrame = false;
+}
+
+bool StreamingFrameSource::readNextFrame()
+{
+    const auto nextFramePosition = hasFrame ? framePosition + hopSize : framePosition;
+
+    if (nextFramePosition + frameSize > reader.lengthInSamples)
+        return false;
+
+    // Samples from the current frame that the next one still needs
+    const int overlap = hasFrame ? (int) juce::jmax((juce::int64) 0, framePosition + frameSize - nextFramePosition) : 0;
+
+    if (overlap > 0)
+    {
+        for (int channel = 0; channel < frame.getNumChannels(); ++channel)
+        {
+            auto* data = frame.getWritePointer(channel);
+            std::memmove(data, data + (frameSize - overlap), sizeof(float) * (size_t) overlap);
+        }
+    }
+    else if (nextReadPosition < nextFramePosition)
+    {
+        skip(nextFramePosition - nextReadPosition);
+    }
+
+    read(overlap, frameSize - overlap, nextFramePosition + overlap);
+
+    framePosition = nextFramePosition;
+    hasFrame = true;
+    return true;
+}
+
+void StreamingFrameSource::read(int destStart, int numSamples, juce::int64 readerPosition)
+{
+    jassert(readerPosition == nextReadPosition);
+
+    reader.read(&frame, destStart, numSamples, readerPosition, true, true);
+    nextReadPosition = readerPosition + numSamples;
+    samplesDecoded += numSamples;
+}
+
+void StreamingFrameSource::skip(juce::int64 numSamples)
+{
+    if (decodeGaps)
+    {
+        // Decode through the gap so the decoder never has to seek
+        while (numSamples > 0)
+        {
+            const int chunk = (int) juce::jmin(numSamples, (juce::int64) gapScratch.getNumSamples());
+            reader.read(&gapScratch, 0, chunk, nextReadPosition, true, true);
+
+            nextReadPosition += chunk;
+            samplesDecoded += chunk;
+            numSamples -= chunk;
+        }
+    }
+    else
+    {
+        nextReadPosition += numSamples;
+    }
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    StreamingFrameSource.h
+
+    Walks an AudioFormatReader front to back and hands out overlapping analysis
+    frames. The frame is a sliding buffer: each step moves the samples that are
+    still needed down by one hop and decodes only the new ones at the end, so
+    nothing is decoded twice and the reader is only ever asked for the next
+    contiguous block.
+
+    When the hop is longer than a frame there is a gap between frames. For
+    formats where seeking is cheap (PCM) the gap is skipped; for compressed
+    formats it is decoded and thrown away, since a decoder seek per frame
+    costs more than decoding straight through.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class StreamingFrameSource
+{
+public:
+    /** The reader must outlive this object and must not be used by anyone else meanwhile. */
+    StreamingFrameSource(juce::AudioFormatReader& reader, int frameSize, int hopSize, int numChannels = 2);
+
+    /** The next call to readNextFrame() returns the frame starting at firstFramePosition. */
+    void reset(juce::int64 firstFramePosition);
+
+    /** Advances to the next frame. Returns false if it would run past the end of the file. */
+    bool readNextFrame();
+
+    /** getFrameSize() samples for each of getNumChannels() channels. Mono files are copied to both channels. */
+    const float* const* getFrame() const noexcept       { return frame.getArrayOfReadPointers(); }
+    int getNumChannels() const noexcept                 { return frame.getNumChannels(); }
+    int getFrameSize() const noexcept                   { return frameSize; }
+    int getHopSize() const noexcept                     { return hopSize; }
+
+    /** Start of the current frame in the file. */
+    juce::int64 getFramePosition() const noexcept       { return framePosition; }
+
+    /** Total samples pulled out of the reader, including any decoded gaps. */
+    juce::int64 getSamplesDecoded() const noexcept      { return samplesDecoded; }
+
+    /** True for formats whose readers can jump to a position without decoding up to it. */
+    static bool canSeekCheaply(const juce::AudioFormatReader&);
+
+private:
+    void read(int destStart, int numSamples, juce::int64 readerPosition);
+    void skip(juce::int64 numSamples);
+
+    juce::AudioFormatReader& reader;
+    const int frameSize, hopSize;
+    const bool decodeGaps;
+
+    juce::AudioBuffer<float> frame;
+    juce::AudioBuffer<float> gapScratch;
+
+    juce::int64 framePosition = 0;
+    juce::int64 nextReadPosition = 0;   // first sample not yet decoded
+    juce::int64 samplesDecoded = 0;
+    bool hasFrame = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamingFrameSource)
+};
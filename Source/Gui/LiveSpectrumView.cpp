@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    LiveSpectrumView.cpp
+
+  ==============================================================================
+*/
+
+#include "LiveSpectrumView.h"
+
+namespace
+{
+    // Share of the height given to the chromagram
+    constexpr float chromaProportion = 0.35f;
+}
+
+LiveSpectrumView::LiveSpectrumView(LiveChordDetector& detectorToShow)
+    : detector(detectorToShow)
+{
+    // Dark blue through magenta and orange to pale yellow, looked up by level
+    juce::ColourGradient gradient(juce::Colour(0xff000004), 0.0f, 0.0f, juce::Colour(0xfffcfdbf), 1.0f, 0.0f, false);
+    gradient.addColour(0.25, juce::Colour(0xff3b0f70));
+    gradient.addColour(0.5, juce::Colour(0xff8c2981));
+    gradient.addColour(0.75, juce::Colour(0xfffe9f6d));
+
+    for (size_t i = 0; i < colourMap.size(); ++i)
+        colourMap[i] = gradient.getColourAtPosition((double) i / (double) (colourMap.size() - 1)).getPixelARGB();
+
+    setOpaque(true);
+    detector.setDisplayEnabled(true);
+    startTimerHz(60);
+}
+
+LiveSpectrumView::~LiveSpectrumView()
+{
+    detector.setDisplayEnabled(false);
+}
+
+void LiveSpectrumView::resized()
+{
+    // One image pixel per screen pixel across, so a column is a column
+    const int width = juce::jmax(1, getWidth());
+
+    if (chromaImage.isValid() && chromaImage.getWidth() == width)
+        return;
+
+    chromaImage = juce::Image(juce::Image::ARGB, width, 12, true);
+    spectrumImage = juce::Image(juce::Image::ARGB, width, Column::numBands, true);
+    writeColumn = 0;
+}
+
+void LiveSpectrumView::timerCallback()
+{
+    bool drewAny = false;
+
+    while (const int numColumns = detector.popDisplayColumns(pending.data(), (int) pending.size()))
+    {
+        for (int i = 0; i < numColumns; ++i)
+            drawColumn(pending[(size_t) i]);
+
+        drewAny = true;
+    }
+
+    if (drewAny)
+    {
+        hasColumns = true;
+        repaint();
+    }
+}
+
+void LiveSpectrumView::drawColumn(const Column& column)
+{
+    if (! chromaImage.isValid())
+        return;
+
+    auto toColour = [this] (float level)
+    {
+        return colourMap[(size_t) juce::jlimit(0, (int) colourMap.size() - 1, (int) (level * (float) (colourMap.size() - 1)))];
+    };
+
+    // Low pitches and frequencies at the bottom
+    {
+        const juce::Image::BitmapData pixels(chromaImage, writeColumn, 0, 1, 12, juce::Image::BitmapData::writeOnly);
+
+        for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+            reinterpret_cast<juce::PixelARGB*>(pixels.getPixelPointer(0, 11 - pitchClass))->set(toColour(column.chroma[(size_t) pitchClass]));
+    }
+
+    {
+        const juce::Image::BitmapData pixels(spectrumImage, writeColumn, 0, 1, Column::numBands, juce::Image::BitmapData::writeOnly);
+
+        for (int band = 0; band < Column::numBands; ++band)
+            reinterpret_cast<juce::PixelARGB*>(pixels.getPixelPointer(0, Column::numBands - 1 - band))->set(toColour(column.spectrum[(size_t) band]));
+    }
+
+    writeColumn = (writeColumn + 1) % chromaImage.getWidth();
+}
+
+void LiveSpectrumView::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colour(colourMap.front()));
+
+    if (! hasColumns)
+    {
+        g.setColour(juce::Colours::grey);
+        g.setFont(13.0f);
+        g.drawText("Turn on Live to see the chromagram and spectrum", getLocalBounds(), juce::Justification::centred);
+        return;
+    }
+
+    // Scaling the 12 chroma rows up should give blocks, not blur
+    g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+
+    auto area = getLocalBounds();
+    const auto chromaArea = area.removeFromTop(juce::roundToInt((float) area.getHeight() * chromaProportion));
+    drawRing(g, chromaImage, chromaArea);
+    drawRing(g, spectrumImage, area.withTrimmedTop(1));
+}
+
+void LiveSpectrumView::drawRing(juce::Graphics& g, const juce::Image& image, juce::Rectangle<int> area) const
+{
+    // Columns from writeColumn onwards are the oldest, so they go on the left
+    const int width = image.getWidth();
+    const int olderWidth = width - writeColumn;
+
+    g.drawImage(image, area.getX(), area.getY(), olderWidth, area.getHeight(),
+                writeColumn, 0, olderWidth, image.getHeight());
+
+    if (writeColumn > 0)
+        g.drawImage(image, area.getX() + olderWidth, area.getY(), writeColumn, area.getHeight(),
+                    0, 0, writeColumn, image.getHeight());
+}
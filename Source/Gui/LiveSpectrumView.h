@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    LiveSpectrumView.h
+
+    Scrolling chromagram (top) and log-frequency spectrogram (bottom) of the
+    live detector's frames. Each frame arrives as a DisplayColumn through
+    the detector's lock-free queue and is written as a single pixel column
+    into two ring-buffered images, colour-mapped through a precomputed
+    table. Nothing already drawn is ever redrawn: paint() blits each ring in
+    two pieces, oldest first, so scrolling costs one column of pixels per
+    frame plus the blit, however wide the view is.
+
+    The detector only produces columns while a view exists, so the analysis
+    thread does no extra work with the editor closed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Analysis/LiveChordDetector.h"
+#include <array>
+
+class LiveSpectrumView  : public juce::Component,
+                          private juce::Timer
+{
+public:
+    explicit LiveSpectrumView(LiveChordDetector& detectorToShow);
+    ~LiveSpectrumView() override;
+
+    void paint(juce::Graphics&) override;
+    void resized() override;
+
+private:
+    using Column = LiveChordDetector::DisplayColumn;
+
+    void timerCallback() override;
+    void drawColumn(const Column&);
+    void drawRing(juce::Graphics&, const juce::Image&, juce::Rectangle<int> area) const;
+
+    LiveChordDetector& detector;
+
+    // One pixel column per frame, written at writeColumn and wrapping round
+    juce::Image chromaImage, spectrumImage;
+    int writeColumn = 0;
+    bool hasColumns = false;
+
+    std::array<juce::PixelARGB, 256> colourMap;
+    std::array<Column, 64> pending;     // scratch for columns popped each tick
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LiveSpectrumView)
+};
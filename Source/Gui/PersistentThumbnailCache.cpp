@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    PersistentThumbnailCache.cpp
+
+  ==============================================================================
+*/
+
+#include "PersistentThumbnailCache.h"
+#include "../Analysis/ChordAnalysisCache.h"
+#include <algorithm>
+
+namespace
+{
+    const char* const fileSuffix = ".thumb";
+}
+
+PersistentThumbnailCache::PersistentThumbnailCache()
+    : PersistentThumbnailCache(getDefaultDirectory())
+{
+}
+
+PersistentThumbnailCache::PersistentThumbnailCache(const juce::File& dir, juce::int64 maxSize)
+    : juce::AudioThumbnailCache(maxThumbnailsInMemory),
+      directory(dir),
+      maxSizeBytes(maxSize)
+{
+}
+
+juce::File PersistentThumbnailCache::getDefaultDirectory()
+{
+    return ChordAnalysisCache::getDefaultDirectory().getChildFile("Thumbnails");
+}
+
+juce::File PersistentThumbnailCache::getFileForHash(juce::int64 hashCode) const
+{
+    return directory.getChildFile(juce::String::toHexString(hashCode).paddedLeft('0', 16) + fileSuffix);
+}
+
+bool PersistentThumbnailCache::loadNewThumb(juce::AudioThumbnailBase& thumbnail, juce::int64 hashCode)
+{
+    const juce::ScopedLock sl(diskLock);
+    const auto file = getFileForHash(hashCode);
+
+    juce::FileInputStream stream(file);
+
+    if (! stream.openedOk() || ! thumbnail.loadFrom(stream))
+        return false;
+
+    // Mark as recently used
+    file.setLastModificationTime(juce::Time::getCurrentTime());
+    return true;
+}
+
+void PersistentThumbnailCache::saveNewlyFinishedThumbnail(const juce::AudioThumbnailBase& thumbnail, juce::int64 hashCode)
+{
+    const juce::ScopedLock sl(diskLock);
+
+    if (directory.createDirectory().failed())
+        return;
+
+    // Write to a temporary file and move it into place, so a reader never sees half a thumbnail
+    const auto file = getFileForHash(hashCode);
+    juce::TemporaryFile temp(file);
+
+    {
+        juce::FileOutputStream stream(temp.getFile());
+
+        if (! stream.openedOk())
+            return;
+
+        thumbnail.saveTo(stream);
+        stream.flush();
+
+        if (stream.getStatus().failed())
+            return;
+    }
+
+    if (temp.overwriteTargetFileWithTemporary())
+        evictLeastRecentlyUsed();
+}
+
+void PersistentThumbnailCache::evictLeastRecentlyUsed()
+{
+    auto files = directory.findChildFiles(juce::File::findFiles, false, juce::String("*") + fileSuffix);
+
+    juce::int64 totalSize = 0;
+    for (auto& f : files)
+        totalSize += f.getSize();
+
+    if (totalSize <= maxSizeBytes)
+        return;
+
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    for (auto& f : files)
+    {
+        if (totalSize <= maxSizeBytes)
+            break;
+
+        const auto size = f.getSize();
+        if (f.deleteFile())
+            totalSize -= size;
+    }
+}
@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    PersistentThumbnailCache.h
+
+    A juce::AudioThumbnailCache that also keeps every finished thumbnail on
+    disk, next to the chord analyses, so a file that has been opened before
+    draws its overview straight away instead of being decoded again. The
+    cache's own thread still builds new thumbnails in the background.
+
+    Thumbnails are keyed by the source's hash (the file's path and
+    modification time for a FileInputSource) and bounded in total size like
+    ChordAnalysisCache: least recently used first, by modification time.
+
+    One instance is shared by every plugin instance in the process; get it
+    through a juce::SharedResourcePointer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class PersistentThumbnailCache  : public juce::AudioThumbnailCache
+{
+public:
+    static constexpr int maxThumbnailsInMemory = 16;
+    static constexpr juce::int64 defaultMaxSizeBytes = 64 * 1024 * 1024;
+
+    PersistentThumbnailCache();
+    explicit PersistentThumbnailCache(const juce::File& directory, juce::int64 maxSizeBytes = defaultMaxSizeBytes);
+
+    /** A "Thumbnails" folder in ChordAnalysisCache's directory. */
+    static juce::File getDefaultDirectory();
+
+protected:
+    bool loadNewThumb(juce::AudioThumbnailBase&, juce::int64 hashCode) override;
+    void saveNewlyFinishedThumbnail(const juce::AudioThumbnailBase&, juce::int64 hashCode) override;
+
+private:
+    juce::File getFileForHash(juce::int64 hashCode) const;
+    void evictLeastRecentlyUsed();
+
+    const juce::File directory;
+    const juce::int64 maxSizeBytes;
+    juce::CriticalSection diskLock;     // loads come from the message thread, saves from the cache's thread
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PersistentThumbnailCache)
+};
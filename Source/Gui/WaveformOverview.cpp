@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    WaveformOverview.cpp
+
+  ==============================================================================
+*/
+
+#include "WaveformOverview.h"
+#include "../Analysis/ChordDetection.h"
+#include "../Analysis/ChordTemplates.h"
+
+namespace
+{
+    constexpr int chordStripHeight = 18;
+}
+
+WaveformOverview::WaveformOverview(juce::AudioThumbnail& thumbnailToShow, FilePlayer& playerToFollow,
+                                   std::function<const ChordTimeline*()> getTimeline)
+    : thumbnail(thumbnailToShow),
+      player(playerToFollow),
+      timelineSource(std::move(getTimeline))
+{
+    // A file loaded before we opened wasn't timed from its start
+    if (const auto loaded = player.getLoadedFile())
+        timedLoadTicks = loaded->loadStartTicks;
+
+    setOpaque(true);
+    thumbnail.addChangeListener(this);
+    startTimerHz(30);
+}
+
+WaveformOverview::~WaveformOverview()
+{
+    thumbnail.removeChangeListener(this);
+}
+
+void WaveformOverview::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+    // More of the thumbnail is ready, or there's a new file
+    repaint();
+}
+
+void WaveformOverview::timerCallback()
+{
+    const auto* timeline = timelineSource();
+
+    if (timeline != drawnTimeline)
+    {
+        drawnTimeline = timeline;
+        repaint();
+        return;
+    }
+
+    // Only the strips under the old and new playhead need drawing again
+    const int x = getPlayheadX();
+
+    if (x != playheadX)
+    {
+        repaint(playheadX - 1, 0, 3, getHeight());
+        repaint(x - 1, 0, 3, getHeight());
+        playheadX = x;
+    }
+}
+
+void WaveformOverview::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colour(0xff1b1f23));
+
+    const auto length = getLengthInSeconds();
+    auto area = getLocalBounds();
+    const auto chordArea = area.removeFromBottom(chordStripHeight);
+
+    if (length <= 0.0)
+    {
+        g.setColour(juce::Colours::grey);
+        g.setFont(13.0f);
+        g.drawText("Import audio to see its waveform", getLocalBounds(), juce::Justification::centred);
+        return;
+    }
+
+    g.setColour(juce::Colour(0xff5fa8d3));
+    thumbnail.drawChannels(g, area.reduced(0, 2), 0.0, length, 1.0f);
+
+    drawnTimeline = timelineSource();
+    drawTimeline(g, chordArea, length);
+
+    g.setColour(juce::Colours::white);
+    g.drawVerticalLine(getPlayheadX(), 0.0f, (float) getHeight());
+
+    updateLoadTime();
+
+    if (loadTimeText.isNotEmpty())
+    {
+        g.setColour(juce::Colours::lightgrey);
+        g.setFont(11.0f);
+        g.drawText(loadTimeText, getLocalBounds().reduced(4, 2), juce::Justification::topRight);
+    }
+}
+
+void WaveformOverview::drawTimeline(juce::Graphics& g, juce::Rectangle<int> area, double length)
+{
+    if (drawnTimeline == nullptr || drawnTimeline->getNumSegments() == 0)
+        return;
+
+    const auto sampleRate = drawnTimeline->getSampleRate();
+    const auto samplesPerPixel = sampleRate * length / juce::jmax(1, getWidth());
+    auto toX = [samplesPerPixel] (juce::int64 sample)   { return (float) ((double) sample / samplesPerPixel); };
+
+    // Start at the segment under the left edge of what is being redrawn
+    const auto clip = g.getClipBounds();
+    const auto numSegments = drawnTimeline->getNumSegments();
+    const auto totalSamples = (juce::int64) (length * sampleRate);
+
+    g.setFont(11.0f);
+
+    for (int i = juce::jmax(0, drawnTimeline->getSegmentIndexAt((juce::int64) (clip.getX() * samplesPerPixel))); i < numSegments; ++i)
+    {
+        const auto segment = drawnTimeline->getSegment(i);
+        const auto end = i + 1 < numSegments ? drawnTimeline->getSegment(i + 1).startSample : totalSamples;
+        const auto left = toX(segment.startSample);
+
+        if (left > (float) clip.getRight())
+            break;
+
+        if (segment.chordIndex < 0)
+            continue;
+
+        // Coloured by root, so key changes and repeated progressions stand out
+        const auto bounds = juce::Rectangle<float>(left, (float) area.getY(), toX(end) - left, (float) area.getHeight());
+        const auto hue = (float) ChordTemplates::getRoot(segment.chordIndex) / 12.0f;
+        g.setColour(juce::Colour::fromHSV(hue, 0.55f, 0.45f + 0.4f * segment.confidence, 1.0f));
+        g.fillRect(bounds.reduced(0.5f, 0.0f));
+
+        const auto name = ChordDetection::getChordName(segment.chordIndex);
+
+        if (bounds.getWidth() > 8.0f * (float) name.length())
+        {
+            g.setColour(juce::Colours::white);
+            g.drawText(name, bounds.reduced(2.0f, 0.0f), juce::Justification::centredLeft, false);
+        }
+    }
+}
+
+void WaveformOverview::updateLoadTime()
+{
+    const auto loaded = player.getLoadedFile();
+
+    if (loaded == nullptr || loaded->loadStartTicks == timedLoadTicks || thumbnail.getNumSamplesFinished() <= 0)
+        return;
+
+    timedLoadTicks = loaded->loadStartTicks;
+    const auto milliseconds = 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - timedLoadTicks);
+
+    // Fully loaded at the first paint means it came from the thumbnail cache
+    loadTimeText = "First paint " + juce::String(milliseconds, 1) + " ms" + (thumbnail.isFullyLoaded() ? " (cached)" : "");
+}
+
+double WaveformOverview::getLengthInSeconds() const
+{
+    const auto length = player.getLengthInSeconds();
+    return length > 0.0 ? length : thumbnail.getTotalLength();
+}
+
+int WaveformOverview::getPlayheadX() const
+{
+    const auto length = getLengthInSeconds();
+    return length > 0.0 ? juce::roundToInt(player.getCurrentPosition() / length * getWidth()) : -1;
+}
+
+void WaveformOverview::mouseDown(const juce::MouseEvent& e)
+{
+    seekTo(e.position.x);
+}
+
+void WaveformOverview::mouseDrag(const juce::MouseEvent& e)
+{
+    seekTo(e.position.x);
+}
+
+void WaveformOverview::seekTo(float x)
+{
+    const auto length = getLengthInSeconds();
+
+    if (length > 0.0 && getWidth() > 0)
+        player.setPosition(juce::jlimit(0.0, length, (double) x / getWidth() * length));
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    WaveformOverview.h
+
+    The whole imported file at a glance: its min/max waveform from a
+    juce::AudioThumbnail, the offline chord timeline as a coloured strip
+    underneath, and the play position. Clicking or dragging seeks.
+
+    The thumbnail is built in the background by the thumbnail cache's
+    thread, or read back from a PersistentThumbnailCache when the file has
+    been opened before, so nothing here ever decodes audio. The view shows
+    how long the file took from load() to its first painted overview.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Analysis/ChordTimeline.h"
+#include "../Playback/FilePlayer.h"
+#include <functional>
+
+class WaveformOverview  : public juce::Component,
+                          private juce::ChangeListener,
+                          private juce::Timer
+{
+public:
+    /** getTimeline is called whenever the strip is drawn, so the timeline
+        it returns only needs to live until the next call.
+    */
+    WaveformOverview(juce::AudioThumbnail& thumbnailToShow, FilePlayer& playerToFollow,
+                     std::function<const ChordTimeline*()> getTimeline);
+    ~WaveformOverview() override;
+
+    void paint(juce::Graphics&) override;
+    void mouseDown(const juce::MouseEvent&) override;
+    void mouseDrag(const juce::MouseEvent&) override;
+
+private:
+    void changeListenerCallback(juce::ChangeBroadcaster*) override;
+    void timerCallback() override;
+
+    void drawTimeline(juce::Graphics&, juce::Rectangle<int> area, double length);
+    void updateLoadTime();
+    double getLengthInSeconds() const;
+    int getPlayheadX() const;
+    void seekTo(float x);
+
+    juce::AudioThumbnail& thumbnail;
+    FilePlayer& player;
+    std::function<const ChordTimeline*()> timelineSource;
+
+    const ChordTimeline* drawnTimeline = nullptr;
+    int playheadX = -1;
+
+    // Load-to-first-paint time of the file loaded while this view was open
+    juce::int64 timedLoadTicks = 0;
+    juce::String loadTimeText;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformOverview)
+};
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    ChordMidiOutput.cpp
+
+  ==============================================================================
+*/
+
+#include "ChordMidiOutput.h"
+#include "../Analysis/ChordTemplates.h"
+
+namespace
+{
+    constexpr int bassOctaveNote = 48;      // C3
+    constexpr int chordOctaveNote = 60;     // C4
+    constexpr juce::uint8 noteVelocity = 100;
+    constexpr int noChordValue = 127;
+}
+
+void ChordMidiOutput::beginBlock(juce::MidiBuffer& midi, bool detectorRunning) noexcept
+{
+    if (detectorRunning && enabled.load(std::memory_order_relaxed))
+        return;
+
+    releaseNotes(midi, 0);
+    currentChord = -1;
+}
+
+void ChordMidiOutput::writeChordChange(juce::MidiBuffer& midi, int sampleOffset, int chordIndex) noexcept
+{
+    if (! enabled.load(std::memory_order_relaxed) || chordIndex == currentChord)
+        return;
+
+    releaseNotes(midi, sampleOffset);
+    currentChord = chordIndex;
+    heldChannel = channel.load(std::memory_order_relaxed);
+
+    if (controllers.load(std::memory_order_relaxed))
+    {
+        const int root = chordIndex >= 0 ? ChordTemplates::getRoot(chordIndex) : noChordValue;
+        const int type = chordIndex >= 0 ? ChordTemplates::getType(chordIndex) : noChordValue;
+        midi.addEvent(juce::MidiMessage::controllerEvent(heldChannel, rootController, root), sampleOffset);
+        midi.addEvent(juce::MidiMessage::controllerEvent(heldChannel, typeController, type), sampleOffset);
+    }
+
+    numHeldNotes = getChordNotes(chordIndex, heldNotes.data());
+
+    for (int i = 0; i < numHeldNotes; ++i)
+        midi.addEvent(juce::MidiMessage::noteOn(heldChannel, heldNotes[(size_t) i], noteVelocity), sampleOffset);
+}
+
+void ChordMidiOutput::reset() noexcept
+{
+    numHeldNotes = 0;
+    currentChord = -1;
+}
+
+int ChordMidiOutput::getChordNotes(int chordIndex, int* notes) noexcept
+{
+    if (chordIndex < 0 || chordIndex >= ChordTemplates::numChords)
+        return 0;
+
+    const int root = ChordTemplates::getRoot(chordIndex);
+    const auto& type = ChordTemplates::chordTypes[ChordTemplates::getType(chordIndex)];
+    const int bass = ChordTemplates::getBassPitchClass(chordIndex);
+
+    int numNotes = 0;
+    notes[numNotes++] = bassOctaveNote + bass;
+
+    // The remaining tones stacked upwards from the root, leaving out the bass's pitch class
+    for (int interval = 0; interval < 12 && numNotes < maxNotes; ++interval)
+        if ((type.intervalMask & (1 << interval)) != 0 && (root + interval) % 12 != bass)
+            notes[numNotes++] = chordOctaveNote + root + interval;
+
+    return numNotes;
+}
+
+void ChordMidiOutput::releaseNotes(juce::MidiBuffer& midi, int sampleOffset) noexcept
+{
+    for (int i = 0; i < numHeldNotes; ++i)
+        midi.addEvent(juce::MidiMessage::noteOff(heldChannel, heldNotes[(size_t) i]), sampleOffset);
+
+    numHeldNotes = 0;
+}
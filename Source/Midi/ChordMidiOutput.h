@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    ChordMidiOutput.h
+
+    Turns detected chord changes into MIDI for instruments downstream: the
+    previous chord's notes are released and the new chord's are struck at
+    the sample where the change falls in the block. The bass note is played
+    an octave below the rest, so inversions come out as voiced.
+
+    Optionally each change also sends the chord as two controllers, since
+    MIDI meta events never leave a plugin: rootController carries the root
+    (0 = C .. 11 = B) and typeController the index into
+    ChordTemplates::chordTypes, both 127 when no chord is detected.
+
+    Everything happens on the audio thread, with the notes held kept in a
+    fixed array, so nothing allocates. The MidiBuffer itself only grows
+    until it has room for the busiest block, and the plugin wrappers reserve
+    space in theirs up front.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+class ChordMidiOutput
+{
+public:
+    static constexpr int rootController = 20;   // undefined in the MIDI spec, so free to use
+    static constexpr int typeController = 21;
+    static constexpr int maxNotes = 6;          // bass plus up to five chord tones
+
+    ChordMidiOutput() = default;
+
+    /** Safe from any thread; notes still held are released in the next block. */
+    void setEnabled(bool shouldBeEnabled) noexcept          { enabled.store(shouldBeEnabled); }
+    bool isEnabled() const noexcept                         { return enabled.load(); }
+
+    void setControllersEnabled(bool shouldSend) noexcept    { controllers.store(shouldSend); }
+    bool areControllersEnabled() const noexcept             { return controllers.load(); }
+
+    /** 1 to 16. */
+    void setChannel(int newChannel) noexcept                { channel.store(juce::jlimit(1, 16, newChannel)); }
+    int getChannel() const noexcept                         { return channel.load(); }
+
+    //==============================================================================
+    /** Call at the start of each block. Releases the held notes if output has
+        been turned off, or if there are no chords to follow (detectorRunning false).
+    */
+    void beginBlock(juce::MidiBuffer& midi, bool detectorRunning) noexcept;
+
+    /** Releases the current chord and plays chordIndex (-1 for none) at sampleOffset. */
+    void writeChordChange(juce::MidiBuffer& midi, int sampleOffset, int chordIndex) noexcept;
+
+    /** Forgets the held notes without sending anything, e.g. when the host restarts playback. */
+    void reset() noexcept;
+
+    /** The notes played for a chord, bass first. Returns how many were written to notes. */
+    static int getChordNotes(int chordIndex, int* notes) noexcept;
+
+private:
+    void releaseNotes(juce::MidiBuffer& midi, int sampleOffset) noexcept;
+
+    std::atomic<bool> enabled { false }, controllers { false };
+    std::atomic<int> channel { 1 };
+
+    // Audio thread only
+    std::array<int, maxNotes> heldNotes {};
+    int numHeldNotes = 0;
+    int heldChannel = 1;
+    int currentChord = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChordMidiOutput)
+};
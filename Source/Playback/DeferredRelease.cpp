@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    DeferredRelease.cpp
+
+  ==============================================================================
+*/
+
+#include "DeferredRelease.h"
+#include <algorithm>
+
+DeferredRelease::DeferredRelease()
+{
+}
+
+DeferredRelease::~DeferredRelease()
+{
+    // Whoever owns the audio thread has stopped it by now
+    stopTimer();
+}
+
+void DeferredRelease::retire(std::shared_ptr<const void> object)
+{
+    if (object == nullptr)
+        return;
+
+    // Read after the new pointer was published: any callback that could have
+    // loaded the old one has already been counted as started. The fence pairs
+    // with CallbackScope's, whatever order the publisher's store used.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto started = callbacksStarted.load();
+
+    const juce::ScopedLock sl(pendingLock);
+    pending.emplace_back(started, std::move(object));
+    releaseFinished();
+
+    if (! pending.empty() && ! isTimerRunning())
+        startTimer(50);
+}
+
+int DeferredRelease::getNumPending() const
+{
+    const juce::ScopedLock sl(pendingLock);
+    return (int) pending.size();
+}
+
+void DeferredRelease::timerCallback()
+{
+    const juce::ScopedLock sl(pendingLock);
+    releaseFinished();
+
+    if (pending.empty())
+        stopTimer();
+}
+
+// Called with pendingLock held
+void DeferredRelease::releaseFinished()
+{
+    const auto finished = callbacksFinished.load();
+
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [finished] (const auto& entry) { return finished >= entry.first; }),
+                  pending.end());
+}
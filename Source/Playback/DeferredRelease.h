@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    DeferredRelease.h
+
+    Lets the message thread replace objects the audio thread reads through
+    plain atomic pointers, without locks on either side. The audio thread
+    marks each callback with a CallbackScope; the message thread publishes
+    a new pointer and hands the old owner to retire(). A retired object is
+    kept until every callback that was running when it was retired has
+    finished, then released on the message thread by a timer, so the audio
+    thread never frees anything.
+
+    Callbacks that start after the swap only ever load the new pointer, so
+    once the ones in flight are done nothing can still be reading the old
+    object: epoch-based reclamation with a single reader.
+
+    That relies on the swap and the callback count being totally ordered.
+    Each side writes one atomic and then reads the other's, so both sides
+    put a sequentially consistent fence between the write and the read.
+    Otherwise both could read the old value (weakly ordered CPUs such as
+    ARM allow it). Then retire() would count too few callbacks while one
+    still saw the old pointer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class DeferredRelease  : private juce::Timer
+{
+public:
+    DeferredRelease();
+    ~DeferredRelease() override;
+
+    /** Put one around everything the audio thread does with the published pointers. */
+    class CallbackScope
+    {
+    public:
+        explicit CallbackScope(DeferredRelease& owner) noexcept
+            : releaser(owner)
+        {
+            // Counted before the callback loads any published pointer
+            releaser.callbacksStarted.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        ~CallbackScope() noexcept                                                   { releaser.callbacksFinished.fetch_add(1); }
+
+    private:
+        DeferredRelease& releaser;
+
+        JUCE_DECLARE_NON_COPYABLE (CallbackScope)
+    };
+
+    /** Keeps the object alive until the audio thread can no longer be using it.
+        Call from any thread but the audio thread, after publishing its replacement.
+    */
+    void retire(std::shared_ptr<const void> object);
+
+    /** Objects waiting to be released, for display and tests. */
+    int getNumPending() const;
+
+private:
+    void timerCallback() override;
+    void releaseFinished();
+
+    std::atomic<juce::uint64> callbacksStarted { 0 }, callbacksFinished { 0 };
+
+    // Each object with the number of callbacks that had started when it was retired.
+    // retire() and the timer can run on different threads; the audio thread never locks.
+    juce::CriticalSection pendingLock;
+    std::vector<std::pair<juce::uint64, std::shared_ptr<const void>>> pending;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeferredRelease)
+};
@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    FilePlayer.cpp
+
+  ==============================================================================
+*/
+
+#include "FilePlayer.h"
+#include "ResampledAudioSource.h"
+#include "../Analysis/AudioFileReaders.h"
+
+FilePlayer::FilePlayer(DeferredRelease& releaserToUse)
+    : releaser(releaserToUse)
+{
+    // Only to report reaching the end of the file, which the audio thread can't do itself
+    startTimerHz(10);
+}
+
+FilePlayer::~FilePlayer()
+{
+    // The audio thread has stopped by now, so nothing can be reading the file
+    stopTimer();
+    published.store(nullptr);
+}
+
+//==============================================================================
+bool FilePlayer::load(juce::AudioFormatManager& formatManager, const juce::File& fileToLoad, double readAheadSeconds,
+                      PolyphaseResampler::Quality quality, double startSeconds)
+{
+    const auto loadStartTicks = juce::Time::getHighResolutionTicks();
+
+    // WAV/AIFF are memory-mapped, so even huge files open without reading them
+    auto reader = AudioFileReaders::createReaderFor(formatManager, fileToLoad);
+
+    if (reader == nullptr)
+        return false;
+
+    auto newFile = std::make_shared<LoadedFile>();
+    newFile->file = fileToLoad;
+    newFile->sampleRate = reader->sampleRate;
+    newFile->lengthInSamples = reader->lengthInSamples;
+    newFile->loadStartTicks = loadStartTicks;
+
+    {
+        const juce::ScopedLock sl(preparationLock);
+
+        // Decoded and converted to the host's rate on the streaming thread
+        const auto playbackRate = isPrepared ? preparedSampleRate.load() : reader->sampleRate;
+        const auto numChannels = (int) juce::jmin(2u, reader->numChannels);
+        auto* resampled = new ResampledAudioSource(new juce::AudioFormatReaderSource(reader.get(), false), true,
+                                                   reader->sampleRate, quality, numChannels);
+
+        newFile->stream = std::make_unique<ReadAheadAudioSource>(resampled, true, juce::roundToInt(readAheadSeconds * playbackRate), numChannels);
+        newFile->reader = std::move(reader);
+
+        if (isPrepared)
+            newFile->stream->prepareToPlay(preparedBlockSize, preparedSampleRate.load());
+
+        newFile->stream->setNextReadPosition((juce::int64) (startSeconds * playbackRate));
+
+        publish(std::move(newFile));
+    }
+
+    sendChangeMessage();
+    return true;
+}
+
+void FilePlayer::unload()
+{
+    {
+        const juce::ScopedLock sl(preparationLock);
+        publish(nullptr);
+    }
+
+    sendChangeMessage();
+}
+
+void FilePlayer::publish(std::shared_ptr<LoadedFile> newFile)
+{
+    // Stop first, so the new file doesn't start mid-fade
+    playing.store(false);
+    published.store(newFile.get(), std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    releaser.retire(std::exchange(loaded, std::move(newFile)));
+}
+
+//==============================================================================
+void FilePlayer::prepareToPlay(double sampleRate, int samplesPerBlock)
+{
+    const juce::ScopedLock sl(preparationLock);
+
+    // Positions are in output samples, so keep the time across a rate change
+    const auto position = getCurrentPosition();
+
+    preparedSampleRate.store(sampleRate);
+    preparedBlockSize = samplesPerBlock;
+    isPrepared = true;
+
+    if (loaded != nullptr)
+    {
+        loaded->stream->prepareToPlay(samplesPerBlock, sampleRate);
+        setPosition(position);
+    }
+}
+
+void FilePlayer::releaseResources()
+{
+    const juce::ScopedLock sl(preparationLock);
+    isPrepared = false;
+
+    if (loaded != nullptr)
+        loaded->stream->releaseResources();
+}
+
+void FilePlayer::getNextAudioBlock(const juce::AudioSourceChannelInfo& info) noexcept
+{
+    // A new file starts silent; the old one is never touched again
+    if (const auto current = generation.load(std::memory_order_acquire); current != activeGeneration)
+    {
+        active = published.load(std::memory_order_relaxed);
+        activeGeneration = current;
+        lastGain = 0.0f;
+    }
+
+    const float gain = playing.load(std::memory_order_relaxed) ? 1.0f : 0.0f;
+
+    if (active == nullptr || (gain == 0.0f && lastGain == 0.0f))
+    {
+        info.clearActiveBufferRegion();
+        lastGain = gain;
+        return;
+    }
+
+    active->stream->getNextAudioBlock(info);
+
+    // Fade over one block on start and stop, as AudioTransportSource does
+    if (gain != lastGain)
+        for (int channel = 0; channel < info.buffer->getNumChannels(); ++channel)
+            info.buffer->applyGainRamp(channel, info.startSample, info.numSamples, lastGain, gain);
+
+    lastGain = gain;
+
+    if (gain > 0.0f && ! active->stream->isLooping()
+         && active->stream->getNextReadPosition() > active->stream->getTotalLength())
+    {
+        playing.store(false);
+        reachedEnd.store(true);
+    }
+}
+
+//==============================================================================
+void FilePlayer::start()
+{
+    if (loaded != nullptr && ! playing.exchange(true))
+        sendChangeMessage();
+}
+
+void FilePlayer::stop()
+{
+    if (playing.exchange(false))
+        sendChangeMessage();
+}
+
+void FilePlayer::setPosition(double seconds)
+{
+    if (loaded != nullptr)
+        loaded->stream->setNextReadPosition((juce::int64) (juce::jmax(0.0, seconds) * getPlaybackRate(*loaded)));
+}
+
+double FilePlayer::getCurrentPosition() const
+{
+    return loaded != nullptr ? (double) loaded->stream->getNextReadPosition() / getPlaybackRate(*loaded) : 0.0;
+}
+
+double FilePlayer::getLengthInSeconds() const
+{
+    return loaded != nullptr ? (double) loaded->lengthInSamples / loaded->sampleRate : 0.0;
+}
+
+double FilePlayer::getPlaybackRate(const LoadedFile& file) const noexcept
+{
+    // Streams work at the host's rate once prepared, and at the file's before
+    return isPrepared ? preparedSampleRate.load() : file.sampleRate;
+}
+
+float FilePlayer::getBufferFillLevel() const
+{
+    return loaded != nullptr ? loaded->stream->getFillLevel() : 0.0f;
+}
+
+int FilePlayer::getNumUnderruns() const
+{
+    return loaded != nullptr ? loaded->stream->getNumUnderruns() : 0;
+}
+
+void FilePlayer::timerCallback()
+{
+    if (reachedEnd.exchange(false))
+        sendChangeMessage();
+}
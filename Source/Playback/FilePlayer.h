@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    FilePlayer.h
+
+    Plays the imported file in the processor, in place of an
+    AudioTransportSource that the editor had to feed. Each load builds a
+    LoadedFile: the reader plus its resampling, read-ahead stream, shared
+    through a shared_ptr and never replaced in place. The audio thread picks
+    up a new one through an atomic pointer at the start of its next block;
+    the old one goes to a DeferredRelease and is destroyed on the message
+    thread once no callback can still be reading it. Loading, starting and
+    seeking never take a lock the audio thread could wait on.
+
+    Positions are in seconds. Listeners hear about starts and stops,
+    including running off the end of the file, on the message thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DeferredRelease.h"
+#include "PolyphaseResampler.h"
+#include "ReadAheadAudioSource.h"
+#include <atomic>
+#include <memory>
+
+class FilePlayer  : public juce::ChangeBroadcaster,
+                    private juce::Timer
+{
+public:
+    struct LoadedFile
+    {
+        juce::File file;
+        double sampleRate = 0.0;
+        juce::int64 lengthInSamples = 0;
+        juce::int64 loadStartTicks = 0;     // when load() was called, for load-to-display timing
+
+        std::unique_ptr<juce::AudioFormatReader> reader;
+        std::unique_ptr<ReadAheadAudioSource> stream;   // reads from reader, so declared after it
+    };
+
+    explicit FilePlayer(DeferredRelease&);
+    ~FilePlayer() override;
+
+    //==============================================================================
+    /** Opens the file and swaps it in, stopped at startSeconds. Call from the
+        message thread. Returns false, keeping the current file, if it can't be read.
+    */
+    bool load(juce::AudioFormatManager&, const juce::File&, double readAheadSeconds,
+              PolyphaseResampler::Quality, double startSeconds = 0.0);
+
+    /** Drops the current file. */
+    void unload();
+
+    /** The current file, or nullptr. Message thread only. */
+    std::shared_ptr<const LoadedFile> getLoadedFile() const noexcept    { return loaded; }
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void releaseResources();
+
+    /** Overwrites the buffer with the file, or silence when stopped. Lock- and allocation-free. */
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo&) noexcept;
+
+    //==============================================================================
+    void start();
+    void stop();
+    bool isPlaying() const noexcept         { return playing.load(); }
+
+    void setPosition(double seconds);
+    double getCurrentPosition() const;
+    double getLengthInSeconds() const;
+
+    /** Read-ahead telemetry for the current file. */
+    float getBufferFillLevel() const;
+    int getNumUnderruns() const;
+
+private:
+    void timerCallback() override;
+    void publish(std::shared_ptr<LoadedFile>);
+    double getPlaybackRate(const LoadedFile&) const noexcept;
+
+    DeferredRelease& releaser;
+
+    juce::CriticalSection preparationLock;      // load() against prepareToPlay(); never taken by the audio thread
+    std::atomic<double> preparedSampleRate { 0.0 };
+    int preparedBlockSize = 0;
+    std::atomic<bool> isPrepared { false };
+
+    std::shared_ptr<LoadedFile> loaded;                     // message thread
+    std::atomic<LoadedFile*> published { nullptr };
+    std::atomic<juce::uint32> generation { 0 };             // bumped on every publish, as addresses get reused
+    LoadedFile* active = nullptr;                           // audio thread only
+    juce::uint32 activeGeneration = 0;                      // audio thread only
+    float lastGain = 0.0f;                                  // audio thread only
+
+    std::atomic<bool> playing { false }, reachedEnd { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilePlayer)
+};
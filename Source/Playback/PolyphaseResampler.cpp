@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+    PolyphaseResampler.cpp
+
+  ==============================================================================
+*/
+
+#include "PolyphaseResampler.h"
+#include <cstring>
+
+#if defined (__AVX__)
+ #include <immintrin.h>
+ #define VSTSAMPLER_RESAMPLER_AVX 1
+#elif defined (__SSE__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 1)
+ #include <xmmintrin.h>
+ #define VSTSAMPLER_RESAMPLER_SSE 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64)
+ #include <arm_neon.h>
+ #define VSTSAMPLER_RESAMPLER_NEON 1
+#endif
+
+namespace
+{
+    struct QualityParameters
+    {
+        int numTaps;
+        double kaiserBeta;
+        double passband;    // of the lower Nyquist frequency
+    };
+
+    QualityParameters getParameters(PolyphaseResampler::Quality quality)
+    {
+        switch (quality)
+        {
+            case PolyphaseResampler::Quality::draft:    return { 16, 6.0, 0.90 };
+            case PolyphaseResampler::Quality::high:     return { 64, 10.0, 0.97 };
+            case PolyphaseResampler::Quality::normal:
+            default:                                    return { 32, 8.0, 0.94 };
+        }
+    }
+
+    // Zeroth-order modified Bessel function of the first kind, for the Kaiser window
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 50 && term > sum * 1.0e-12; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    // numSamples is always a multiple of 16, the shortest kernel
+    inline float dotProduct(const float* a, const float* b, int numSamples) noexcept
+    {
+       #if VSTSAMPLER_RESAMPLER_AVX
+        auto sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+
+        for (int i = 0; i < numSamples; i += 16)
+        {
+            sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i)));
+            sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+        }
+
+        const auto sum = _mm256_add_ps(sum0, sum1);
+        auto quad = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        quad = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+        quad = _mm_add_ss(quad, _mm_shuffle_ps(quad, quad, 1));
+        return _mm_cvtss_f32(quad);
+       #elif VSTSAMPLER_RESAMPLER_SSE
+        auto sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+
+        for (int i = 0; i < numSamples; i += 8)
+        {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i),     _mm_loadu_ps(b + i)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+
+        auto quad = _mm_add_ps(sum0, sum1);
+        quad = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+        quad = _mm_add_ss(quad, _mm_shuffle_ps(quad, quad, 1));
+        return _mm_cvtss_f32(quad);
+       #elif VSTSAMPLER_RESAMPLER_NEON
+        auto sum0 = vdupq_n_f32(0.0f), sum1 = vdupq_n_f32(0.0f);
+
+        for (int i = 0; i < numSamples; i += 8)
+        {
+            sum0 = vmlaq_f32(sum0, vld1q_f32(a + i),     vld1q_f32(b + i));
+            sum1 = vmlaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+
+        const auto quad = vaddq_f32(sum0, sum1);
+        const auto pair = vadd_f32(vget_low_f32(quad), vget_high_f32(quad));
+        return vget_lane_f32(vpadd_f32(pair, pair), 0);
+       #else
+        float sum = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+            sum += a[i] * b[i];
+
+        return sum;
+       #endif
+    }
+}
+
+//==============================================================================
+void PolyphaseResampler::prepare(int numChannels, double newRatio, Quality quality, int maximumOutputBlockSize)
+{
+    jassert(newRatio > 0.0);
+
+    ratio = newRatio;
+    maximumOutputBlock = juce::jmax(1, maximumOutputBlockSize);
+    step = (juce::int64) std::llround(ratio * 4294967296.0);
+
+    buildTable(quality);
+
+    // Room for what a full block reads on top of what's left over from the last one
+    history.setSize(juce::jmax(1, numChannels), 2 * numTaps + (int) std::ceil(maximumOutputBlock * ratio) + 2);
+    reset();
+}
+
+void PolyphaseResampler::reset() noexcept
+{
+    // Zeros before the first input, so output 0 lands exactly on input 0
+    history.clear();
+    numBuffered = juce::jmax(0, numTaps / 2 - 1);
+    position = 0;
+}
+
+void PolyphaseResampler::buildTable(Quality quality)
+{
+    const auto parameters = getParameters(quality);
+    numTaps = parameters.numTaps;
+
+    // Cut off below whichever Nyquist frequency is lower
+    const double cutoff = parameters.passband * juce::jmin(1.0, 1.0 / ratio);
+    const double halfWidth = numTaps / 2;
+    const double centre = numTaps / 2 - 1;
+    const double windowScale = 1.0 / besselI0(parameters.kaiserBeta);
+
+    table.allocate((size_t) ((numPhases + 1) * numTaps), false);
+
+    for (int phase = 0; phase <= numPhases; ++phase)
+    {
+        float* kernel = table + phase * numTaps;
+        const double offset = (double) phase / numPhases;
+        double sum = 0.0;
+
+        for (int tap = 0; tap < numTaps; ++tap)
+        {
+            const double x = tap - centre - offset;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * cutoff * x) / (juce::MathConstants<double>::pi * cutoff * x);
+            const double r = x / halfWidth;
+            const double window = r * r < 1.0 ? besselI0(parameters.kaiserBeta * std::sqrt(1.0 - r * r)) * windowScale : 0.0;
+
+            kernel[tap] = (float) (cutoff * sinc * window);
+            sum += kernel[tap];
+        }
+
+        // Unity gain at DC for every phase, so the blend between phases can't ripple
+        for (int tap = 0; tap < numTaps; ++tap)
+            kernel[tap] = (float) (kernel[tap] / sum);
+    }
+}
+
+//==============================================================================
+int PolyphaseResampler::getNumInputNeeded(int numOutput) const noexcept
+{
+    if (numOutput <= 0)
+        return 0;
+
+    // The last output reads numTaps samples from its integer position on
+    const auto lastIndex = (int) ((position + (juce::int64) (numOutput - 1) * step) >> 32);
+    return juce::jmax(0, lastIndex + numTaps - numBuffered);
+}
+
+void PolyphaseResampler::process(const float* const* input, float* const* output, int numOutput) noexcept
+{
+    jassert(numOutput <= maximumOutputBlock);
+
+    const int numInput = getNumInputNeeded(numOutput);
+    const int numChannels = history.getNumChannels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        history.copyFrom(channel, numBuffered, input[channel], numInput);
+
+    numBuffered += numInput;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const float* source = history.getReadPointer(channel);
+        float* dest = output[channel];
+        auto readPosition = position;
+
+        for (int i = 0; i < numOutput; ++i)
+        {
+            // The top bits of the fraction pick the two nearest kernels, the rest blends them
+            const auto index = (int) (readPosition >> 32);
+            const auto phase = (readPosition & 0xffffffff) * numPhases;
+            const auto kernelIndex = (int) (phase >> 32);
+            const auto blend = (float) (phase & 0xffffffff) * (1.0f / 4294967296.0f);
+
+            const float* kernel = table + kernelIndex * numTaps;
+            const float early = dotProduct(source + index, kernel, numTaps);
+            const float late = dotProduct(source + index, kernel + numTaps, numTaps);
+            dest[i] = early + blend * (late - early);
+
+            readPosition += step;
+        }
+    }
+
+    position += (juce::int64) numOutput * step;
+
+    // Drop the input every later output is past. When downsampling by more than
+    // the kernel length, the next output can start beyond what has arrived yet.
+    const auto consumed = juce::jmin(numBuffered, (int) (position >> 32));
+    numBuffered -= consumed;
+    position -= (juce::int64) consumed << 32;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* data = history.getWritePointer(channel);
+        std::memmove(data, data + consumed, sizeof(float) * (size_t) numBuffered);
+    }
+}
+
+//==============================================================================
+juce::AudioBuffer<float> PolyphaseResampler::resampleBuffer(const juce::AudioBuffer<float>& input, double ratio, Quality quality)
+{
+    const int numChannels = input.getNumChannels();
+    const int outputLength = (int) std::ceil(input.getNumSamples() / ratio);
+    constexpr int blockSize = 4096;
+
+    PolyphaseResampler resampler;
+    resampler.prepare(numChannels, ratio, quality, blockSize);
+
+    // The last outputs read up to a kernel's length past the end
+    juce::AudioBuffer<float> padded(numChannels, input.getNumSamples() + 2 * resampler.getNumTaps() + 2);
+    padded.clear();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        padded.copyFrom(channel, 0, input, channel, 0, input.getNumSamples());
+
+    juce::AudioBuffer<float> output(numChannels, outputLength);
+    juce::HeapBlock<const float*> inputs((size_t) numChannels);
+    juce::HeapBlock<float*> outputs((size_t) numChannels);
+    int inputPosition = 0;
+
+    for (int done = 0; done < outputLength; done += blockSize)
+    {
+        const int numOutput = juce::jmin(blockSize, outputLength - done);
+        const int numInput = resampler.getNumInputNeeded(numOutput);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            inputs[channel] = padded.getReadPointer(channel, inputPosition);
+            outputs[channel] = output.getWritePointer(channel, done);
+        }
+
+        resampler.process(inputs, outputs, numOutput);
+        inputPosition += numInput;
+    }
+
+    return output;
+}
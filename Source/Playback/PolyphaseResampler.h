@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    PolyphaseResampler.h
+
+    Band-limited sample-rate conversion by a fixed ratio. Each output sample
+    is the dot product of the input around its position with a Kaiser-
+    windowed sinc, scaled to the lower of the two Nyquist frequencies so
+    downsampling doesn't alias. The kernels are precomputed in prepare() for
+    256 sub-sample phases; an output between two phases blends the results
+    of its neighbours, so any ratio works without recomputing anything.
+
+    The dot products use AVX, SSE or NEON, whichever the build targets, with
+    a scalar fallback. The read position is 32.32 fixed point, so long runs
+    don't drift.
+
+    process() never allocates. The output is aligned with the input: output
+    sample n sits at input time n * ratio, with no added latency.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class PolyphaseResampler
+{
+public:
+    enum class Quality
+    {
+        draft = 1,      // 16 taps
+        normal,         // 32 taps
+        high            // 64 taps
+    };
+
+    static juce::StringArray getQualityNames()      { return { "Draft", "Normal", "High" }; }
+
+    PolyphaseResampler() = default;
+
+    /** Builds the kernel table and history for a ratio of input samples per
+        output sample, for calls of up to maximumOutputBlock samples. Allocates.
+    */
+    void prepare(int numChannels, double ratio, Quality, int maximumOutputBlock);
+
+    /** Forgets the input history, as if the next input followed silence. */
+    void reset() noexcept;
+
+    /** How many input samples per channel process() reads to produce numOutput. */
+    int getNumInputNeeded(int numOutput) const noexcept;
+
+    /** Reads getNumInputNeeded(numOutput) samples from each input channel and
+        writes numOutput to each output channel. numOutput must be no more than
+        the block size given to prepare().
+    */
+    void process(const float* const* input, float* const* output, int numOutput) noexcept;
+
+    double getRatio() const noexcept                { return ratio; }
+    int getNumTaps() const noexcept                 { return numTaps; }
+    int getMaximumOutputBlock() const noexcept      { return maximumOutputBlock; }
+
+    /** Resamples a whole buffer, e.g. a sample decoded into memory. The result
+        holds ceil(length / ratio) samples.
+    */
+    static juce::AudioBuffer<float> resampleBuffer(const juce::AudioBuffer<float>&, double ratio, Quality);
+
+private:
+    static constexpr int numPhases = 256;
+
+    void buildTable(Quality);
+
+    double ratio = 1.0;
+    int numTaps = 0, maximumOutputBlock = 0;
+
+    // numPhases + 1 kernels of numTaps coefficients; kernel k is for a sub-sample offset of k / numPhases
+    juce::HeapBlock<float> table;
+
+    // The input not yet consumed, starting numTaps / 2 - 1 samples before the next output
+    juce::AudioBuffer<float> history;
+    int numBuffered = 0;
+    juce::int64 position = 0, step = 0;    // 32.32 fixed point, relative to the start of history
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResampler)
+};
@@ -0,0 +1,231 @@
+/*
+  ==============================================================================
+
+    ReadAheadAudioSource.cpp
+
+  ==============================================================================
+*/
+
+#include "ReadAheadAudioSource.h"
+
+ReadAheadAudioSource::SharedThread::SharedThread()
+    : juce::TimeSliceThread("Read-ahead streaming")
+{
+    startThread();
+}
+
+ReadAheadAudioSource::SharedThread::~SharedThread()
+{
+    stopThread(2000);
+}
+
+//==============================================================================
+ReadAheadAudioSource::ReadAheadAudioSource(juce::PositionableAudioSource* sourceToUse, bool deleteSourceWhenDeleted,
+                                           int readAheadSamples, int numChannelsToBuffer)
+    : source(sourceToUse, deleteSourceWhenDeleted),
+      numChannels(juce::jmax(1, numChannelsToBuffer)),
+      ringSize(juce::jmax(1024, readAheadSamples))
+{
+    jassert(sourceToUse != nullptr);
+}
+
+ReadAheadAudioSource::~ReadAheadAudioSource()
+{
+    releaseResources();
+}
+
+void ReadAheadAudioSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    // Waits for any fill in progress, so the ring can be reallocated
+    thread->removeTimeSliceClient(this);
+
+    source->prepareToPlay(samplesPerBlockExpected, sampleRate);
+
+    // At least two blocks, so a full ring always covers the next callback
+    ringSize = juce::jmax(ringSize, 2 * samplesPerBlockExpected);
+    ring.setSize(numChannels, ringSize);
+
+    samplesWritten.store(0);
+    samplesRead.store(0);
+    numUnderruns.store(0);
+    isPrepared = true;
+
+    // Refill from wherever playback had got to
+    setNextReadPosition(getNextReadPosition());
+    thread->addTimeSliceClient(this);
+}
+
+void ReadAheadAudioSource::releaseResources()
+{
+    thread->removeTimeSliceClient(this);
+
+    if (isPrepared)
+    {
+        isPrepared = false;
+        ring.setSize(0, 0);
+        source->releaseResources();
+    }
+}
+
+//==============================================================================
+void ReadAheadAudioSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    const auto generation = seeksRequested.load();
+
+    if (! isPrepared || seeksAcknowledged.load() != generation)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    // Skip to where the streaming thread restarted. Checking the request count
+    // again makes sure both values belong to this seek and not a newer one.
+    if (seekPlaying.load(std::memory_order_relaxed) != generation)
+    {
+        const auto firstIndex = firstIndexOfSeek.load();
+        const auto position = seekPosition.load();
+
+        if (seeksRequested.load() != generation)
+        {
+            info.clearActiveBufferRegion();
+            return;
+        }
+
+        samplesRead.store(juce::jmax(samplesRead.load(), firstIndex));
+        playingFirstIndex = firstIndex;
+        playingFromPosition = position;
+        priming = true;
+        seekPlaying.store(generation);
+    }
+
+    const auto read = samplesRead.load(std::memory_order_relaxed);
+    const int available = (int) juce::jmin((juce::int64) info.numSamples, samplesWritten.load(std::memory_order_acquire) - read);
+
+    // Straight after a seek, wait for a whole block rather than count the wait as an underrun
+    if (priming)
+    {
+        if (available < info.numSamples)
+        {
+            info.clearActiveBufferRegion();
+            return;
+        }
+
+        priming = false;
+    }
+
+    const int start = (int) (read % ringSize);
+    const int firstPart = juce::jmin(available, ringSize - start);
+
+    for (int channel = 0; channel < info.buffer->getNumChannels(); ++channel)
+    {
+        const int ringChannel = juce::jmin(channel, numChannels - 1);
+        info.buffer->copyFrom(channel, info.startSample, ring, ringChannel, start, firstPart);
+
+        if (available > firstPart)
+            info.buffer->copyFrom(channel, info.startSample + firstPart, ring, ringChannel, 0, available - firstPart);
+    }
+
+    if (available < info.numSamples)
+    {
+        info.buffer->clear(info.startSample + available, info.numSamples - available);
+        numUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    samplesRead.store(read + available, std::memory_order_release);
+    playPosition.store(playingFromPosition + (read + available - playingFirstIndex));
+}
+
+//==============================================================================
+int ReadAheadAudioSource::useTimeSlice()
+{
+    if (! isPrepared)
+        return 100;
+
+    // Restart from a new position: the audio thread drops whatever is before firstIndexOfSeek
+    const auto generation = seeksRequested.load();
+
+    if (generation != seekInProgress)
+    {
+        const auto position = requestedPosition.load();
+        source->setNextReadPosition(position);
+
+        firstIndexOfSeek.store(samplesWritten.load());
+        seekPosition.store(position);
+        seekInProgress = generation;
+        seeksAcknowledged.store(generation);
+    }
+
+    // Top up in chunks, so a seek never waits behind a long read
+    constexpr int minChunk = 512, maxChunk = 16384;
+    const auto written = samplesWritten.load(std::memory_order_relaxed);
+    const int space = ringSize - (int) (written - samplesRead.load(std::memory_order_acquire));
+
+    if (space < minChunk)
+        return 5;
+
+    const int numToRead = juce::jmin(space, maxChunk);
+    readIntoRing(written, numToRead);
+    samplesWritten.store(written + numToRead, std::memory_order_release);
+
+    return space - numToRead >= minChunk ? 0 : 5;
+}
+
+void ReadAheadAudioSource::readIntoRing(juce::int64 ringIndex, int numSamples)
+{
+    const int start = (int) (ringIndex % ringSize);
+    const int firstPart = juce::jmin(numSamples, ringSize - start);
+
+    source->getNextAudioBlock(juce::AudioSourceChannelInfo(&ring, start, firstPart));
+
+    if (numSamples > firstPart)
+        source->getNextAudioBlock(juce::AudioSourceChannelInfo(&ring, 0, numSamples - firstPart));
+}
+
+//==============================================================================
+void ReadAheadAudioSource::setNextReadPosition(juce::int64 newPosition)
+{
+    // The position first, so anyone who sees the new request also sees where it goes
+    requestedPosition.store(newPosition);
+    seeksRequested.fetch_add(1);
+
+    thread->moveToFrontOfQueue(this);
+}
+
+juce::int64 ReadAheadAudioSource::getNextReadPosition() const
+{
+    const auto position = seeksRequested.load() != seekPlaying.load() ? requestedPosition.load()
+                                                                      : playPosition.load();
+    const auto length = getTotalLength();
+
+    return isLooping() && length > 0 ? position % length : position;
+}
+
+juce::int64 ReadAheadAudioSource::getTotalLength() const
+{
+    return source->getTotalLength();
+}
+
+bool ReadAheadAudioSource::isLooping() const
+{
+    return source->isLooping();
+}
+
+void ReadAheadAudioSource::setLooping(bool shouldLoop)
+{
+    if (shouldLoop == isLooping())
+        return;
+
+    // What's buffered past the end was read with the old setting
+    const auto position = getNextReadPosition();
+    source->setLooping(shouldLoop);
+    setNextReadPosition(position);
+}
+
+float ReadAheadAudioSource::getFillLevel() const noexcept
+{
+    if (! isPrepared)
+        return 0.0f;
+
+    const auto buffered = samplesWritten.load(std::memory_order_relaxed) - samplesRead.load(std::memory_order_relaxed);
+    return juce::jlimit(0.0f, 1.0f, (float) buffered / (float) ringSize);
+}
@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    ReadAheadAudioSource.h
+
+    Streams a PositionableAudioSource from a background thread, so file
+    decoding (and the page faults of memory-mapped reads) never happen on the
+    audio thread. A TimeSliceThread keeps a ring buffer of up to
+    readAheadSamples filled ahead of the play position; getNextAudioBlock()
+    only copies out of it.
+
+    The ring is a single-producer, single-consumer queue over absolute sample
+    counts, so neither side ever takes a lock. A seek from the message thread
+    is only a request: the background thread refills from the new position
+    and the audio thread plays silence until it has, without counting that
+    as an underrun.
+
+    If the audio thread finds fewer samples than it needs, it plays what is
+    there, pads with silence and counts an underrun. Playback then carries on
+    from where the data stopped, so the position stays in step with what has
+    actually been heard.
+
+    All instances in the process share one streaming thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+class ReadAheadAudioSource  : public juce::PositionableAudioSource,
+                              private juce::TimeSliceClient
+{
+public:
+    static constexpr double defaultReadAheadSeconds = 1.0;
+
+    /** Reads up to readAheadSamples ahead of the play position, for up to numChannels channels. */
+    ReadAheadAudioSource(juce::PositionableAudioSource* source, bool deleteSourceWhenDeleted,
+                         int readAheadSamples, int numChannels = 2);
+    ~ReadAheadAudioSource() override;
+
+    //==============================================================================
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+
+    /** Copies from the ring buffer. Never blocks, reads the file or allocates. */
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo&) override;
+
+    /** Asks the streaming thread to refill from a new position. */
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override;
+    bool isLooping() const override;
+    void setLooping(bool shouldLoop) override;
+
+    //==============================================================================
+    int getReadAheadSamples() const noexcept        { return ringSize; }
+
+    /** How full the read-ahead buffer is, from 0 to 1. */
+    float getFillLevel() const noexcept;
+
+    /** Blocks that ran out of buffered audio since prepareToPlay() or resetUnderruns(). */
+    int getNumUnderruns() const noexcept            { return numUnderruns.load(std::memory_order_relaxed); }
+    void resetUnderruns() noexcept                  { numUnderruns.store(0, std::memory_order_relaxed); }
+
+private:
+    struct SharedThread  : public juce::TimeSliceThread
+    {
+        SharedThread();
+        ~SharedThread() override;
+    };
+
+    int useTimeSlice() override;
+    void readIntoRing(juce::int64 ringIndex, int numSamples);
+
+    juce::OptionalScopedPointer<juce::PositionableAudioSource> source;
+    juce::SharedResourcePointer<SharedThread> thread;
+    const int numChannels;
+    int ringSize;
+
+    juce::AudioBuffer<float> ring;
+    std::atomic<bool> isPrepared { false };
+
+    // Absolute sample counts: the streaming thread advances written, the audio thread read
+    std::atomic<juce::int64> samplesWritten { 0 }, samplesRead { 0 };
+
+    // Seeks: the message thread bumps requested; the streaming thread answers with
+    // acknowledged once it is reading from seekPosition into the ring at firstIndexOfSeek
+    std::atomic<juce::int64> requestedPosition { 0 };
+    std::atomic<juce::uint32> seeksRequested { 0 }, seeksAcknowledged { 0 };
+    std::atomic<juce::int64> firstIndexOfSeek { 0 }, seekPosition { 0 };
+    juce::uint32 seekInProgress = 0;                // streaming thread only
+    std::atomic<juce::uint32> seekPlaying { 0 };    // written by the audio thread
+
+    // Audio thread only: where the seek being played starts, in the ring and in the source
+    juce::int64 playingFirstIndex = 0, playingFromPosition = 0;
+    bool priming = false;
+
+    std::atomic<juce::int64> playPosition { 0 };
+    std::atomic<int> numUnderruns { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReadAheadAudioSource)
+};
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    ResampledAudioSource.cpp
+
+  ==============================================================================
+*/
+
+#include "ResampledAudioSource.h"
+
+ResampledAudioSource::ResampledAudioSource(juce::PositionableAudioSource* inputToUse, bool deleteInputWhenDeleted,
+                                           double inputRate, PolyphaseResampler::Quality qualityToUse, int numChannelsToUse)
+    : input(inputToUse, deleteInputWhenDeleted),
+      inputSampleRate(inputRate),
+      quality(qualityToUse),
+      numChannels(juce::jmax(1, numChannelsToUse))
+{
+    jassert(inputToUse != nullptr && inputRate > 0.0);
+}
+
+void ResampledAudioSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    // Keep the position in time when the output rate changes
+    const auto inputPosition = input->getNextReadPosition();
+    ratio = sampleRate > 0.0 ? inputSampleRate / sampleRate : 1.0;
+
+    // Callers such as ReadAheadAudioSource ask for more than a device block at a time
+    const int maximumBlock = juce::jmax(samplesPerBlockExpected, 4096);
+    resampler.prepare(numChannels, ratio, quality, maximumBlock);
+    inputBuffer.setSize(numChannels, resampler.getNumInputNeeded(maximumBlock) + 2 * resampler.getNumTaps());
+
+    input->prepareToPlay(inputBuffer.getNumSamples(), inputSampleRate);
+    setNextReadPosition((juce::int64) (inputPosition / ratio));
+}
+
+void ResampledAudioSource::releaseResources()
+{
+    input->releaseResources();
+}
+
+void ResampledAudioSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    if (ratio == 1.0)
+    {
+        input->getNextAudioBlock(info);
+        outputPosition += info.numSamples;
+        return;
+    }
+
+    jassert(info.buffer->getNumChannels() >= numChannels);
+
+    float* outputs[2] = {};
+    jassert(numChannels <= (int) std::size(outputs));
+
+    for (int done = 0; done < info.numSamples;)
+    {
+        const int numOutput = juce::jmin(info.numSamples - done, resampler.getMaximumOutputBlock());
+        const int numInput = resampler.getNumInputNeeded(numOutput);
+
+        if (numInput > 0)
+            input->getNextAudioBlock(juce::AudioSourceChannelInfo(&inputBuffer, 0, numInput));
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            outputs[channel] = info.buffer->getWritePointer(channel, info.startSample + done);
+
+        resampler.process(inputBuffer.getArrayOfReadPointers(), outputs, numOutput);
+        done += numOutput;
+    }
+
+    // Any extra output channels get a copy of the last one
+    for (int channel = numChannels; channel < info.buffer->getNumChannels(); ++channel)
+        info.buffer->copyFrom(channel, info.startSample, *info.buffer, numChannels - 1, info.startSample, info.numSamples);
+
+    outputPosition += info.numSamples;
+}
+
+void ResampledAudioSource::setNextReadPosition(juce::int64 newPosition)
+{
+    outputPosition = newPosition;
+    input->setNextReadPosition((juce::int64) std::llround((double) newPosition * ratio));
+    resampler.reset();
+}
+
+juce::int64 ResampledAudioSource::getNextReadPosition() const
+{
+    const auto length = getTotalLength();
+    return isLooping() && length > 0 ? outputPosition % length : outputPosition;
+}
+
+juce::int64 ResampledAudioSource::getTotalLength() const
+{
+    return (juce::int64) ((double) input->getTotalLength() / ratio);
+}
+
+bool ResampledAudioSource::isLooping() const
+{
+    return input->isLooping();
+}
+
+void ResampledAudioSource::setLooping(bool shouldLoop)
+{
+    input->setLooping(shouldLoop);
+}
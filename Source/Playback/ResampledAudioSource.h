@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    ResampledAudioSource.h
+
+    Plays a PositionableAudioSource recorded at one sample rate at the rate
+    given to prepareToPlay(), through a PolyphaseResampler. Positions and
+    lengths are in output samples, so a transport driving it needs no
+    sample rate of its own and reports times in real seconds.
+
+    Put it under a ReadAheadAudioSource and the resampling runs on the
+    streaming thread along with the decoding. When the two rates match it
+    passes the audio straight through.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PolyphaseResampler.h"
+
+class ResampledAudioSource  : public juce::PositionableAudioSource
+{
+public:
+    ResampledAudioSource(juce::PositionableAudioSource* input, bool deleteInputWhenDeleted,
+                         double inputSampleRate, PolyphaseResampler::Quality, int numChannels = 2);
+
+    //==============================================================================
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo&) override;
+
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override;
+    bool isLooping() const override;
+    void setLooping(bool shouldLoop) override;
+
+    /** Input samples per output sample, or 1 before prepareToPlay(). */
+    double getRatio() const noexcept        { return ratio; }
+
+private:
+    juce::OptionalScopedPointer<juce::PositionableAudioSource> input;
+    const double inputSampleRate;
+    const PolyphaseResampler::Quality quality;
+    const int numChannels;
+
+    double ratio = 1.0;
+    PolyphaseResampler resampler;
+    juce::AudioBuffer<float> inputBuffer;
+    juce::int64 outputPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResampledAudioSource)
+};
@@ -11,19 +11,22 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "Analysis/ChordDetection.h"
 #include <vector>
 #include <cassert>
-#include <fstream>
 
 //==============================================================================
 VSTSamplerAudioProcessorEditor::VSTSamplerAudioProcessorEditor(VSTSamplerAudioProcessor& p)
-    : AudioProcessorEditor(&p), p(p), state(Stopped), sampleRate(p.getSampleRate())
+    : AudioProcessorEditor(&p), p(p), state(Stopped)
 {
 
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
 
-    setSize(400, 250);
+    // The overview and spectrum view take whatever space there is below the controls
+    setResizable(true, false);
+    setResizeLimits(400, 620, 2560, 1440);
+    setSize(400, 660);
 
     importButton.onClick = [this] {importButtonClicked();};
     addAndMakeVisible(&importButton);
@@ -47,8 +50,45 @@ VSTSamplerAudioProcessorEditor::VSTSamplerAudioProcessorEditor(VSTSamplerAudioPr
 
 
 
-    formatManager.registerBasicFormats();
-    p.transport.addChangeListener(this);
+    samplesButton.onClick = [this] {samplesButtonClicked(); };
+    samplesButton.setButtonText("Samples");
+    addAndMakeVisible(&samplesButton);
+
+    samplerLabel.setFont(12.0f);
+    addAndMakeVisible(samplerLabel);
+    updateSamplerLabel();
+
+    for (int i = 0; i < (int) std::size(readAheadChoicesSeconds); ++i)
+    {
+        readAheadBox.addItem("Read-ahead " + juce::String(readAheadChoicesSeconds[i], 2) + " s", i + 1);
+
+        if (p.getReadAheadSeconds() == readAheadChoicesSeconds[i])
+            readAheadBox.setSelectedId(i + 1, juce::dontSendNotification);
+    }
+
+    readAheadBox.onChange = [this] {
+        const auto index = readAheadBox.getSelectedId() - 1;
+        if (juce::isPositiveAndBelow(index, (int) std::size(readAheadChoicesSeconds)))
+            this->p.setReadAheadSeconds(readAheadChoicesSeconds[index]);
+
+        this->p.reloadPlaybackFile();
+    };
+    addAndMakeVisible(&readAheadBox);
+
+    // How the file is converted to the host's rate as it plays
+    for (auto& name : PolyphaseResampler::getQualityNames())
+        resamplingBox.addItem(name + " SRC", resamplingBox.getNumItems() + 1);
+    resamplingBox.setSelectedId((int) p.getResamplingQuality(), juce::dontSendNotification);
+    resamplingBox.onChange = [this] {
+        this->p.setResamplingQuality((PolyphaseResampler::Quality) resamplingBox.getSelectedId());
+        this->p.reloadPlaybackFile();
+    };
+    addAndMakeVisible(&resamplingBox);
+
+    streamingLabel.setFont(12.0f);
+    addAndMakeVisible(streamingLabel);
+
+    p.player.addChangeListener(this);
 
 
     chordLabel.setFont(20.0f);
@@ -56,6 +96,100 @@ VSTSamplerAudioProcessorEditor::VSTSamplerAudioProcessorEditor(VSTSamplerAudioPr
     chordLabel.setText("No Chord Detected", juce::dontSendNotification);
     addAndMakeVisible(chordLabel);
 
+
+    liveButton.onClick = [this] {liveButtonClicked(); };
+    liveButton.setButtonText("Live");
+    liveButton.setToggleState(p.liveChordDetector.isEnabled(), juce::dontSendNotification);
+    addAndMakeVisible(&liveButton);
+
+    liveSourceBox.addItem("Transport", 1);
+    liveSourceBox.addItem("Input", 2);
+    liveSourceBox.setSelectedId(p.getLiveSource() == VSTSamplerAudioProcessor::LiveSource::input ? 2 : 1, juce::dontSendNotification);
+    liveSourceBox.onChange = [this] {
+        this->p.setLiveSource(liveSourceBox.getSelectedId() == 2 ? VSTSamplerAudioProcessor::LiveSource::input
+                                                                 : VSTSamplerAudioProcessor::LiveSource::transport);
+    };
+    addAndMakeVisible(&liveSourceBox);
+
+    midiOutButton.setButtonText("MIDI chords");
+    midiOutButton.setToggleState(p.chordMidiOutput.isEnabled(), juce::dontSendNotification);
+    midiOutButton.onClick = [this] {this->p.chordMidiOutput.setEnabled(midiOutButton.getToggleState()); };
+    addAndMakeVisible(&midiOutButton);
+
+    chordControllersButton.setButtonText("Chord CCs");
+    chordControllersButton.setToggleState(p.chordMidiOutput.areControllersEnabled(), juce::dontSendNotification);
+    chordControllersButton.onClick = [this] {this->p.chordMidiOutput.setControllersEnabled(chordControllersButton.getToggleState()); };
+    addAndMakeVisible(&chordControllersButton);
+
+    for (int channel = 1; channel <= 16; ++channel)
+        midiChannelBox.addItem("Channel " + juce::String(channel), channel);
+    midiChannelBox.setSelectedId(p.chordMidiOutput.getChannel(), juce::dontSendNotification);
+    midiChannelBox.onChange = [this] {this->p.chordMidiOutput.setChannel(midiChannelBox.getSelectedId()); };
+    addAndMakeVisible(&midiChannelBox);
+
+    addAndMakeVisible(overview);
+    addAndMakeVisible(spectrumView);
+
+    addAndMakeVisible(analysisProgressBar);
+
+    // Frame/FFT size for both analyses; the hop only applies to Chord ID
+    presetBox.addItemList(AnalysisSettings::getPresetNames(), (int) AnalysisSettings::Preset::standard);
+    presetBox.setSelectedId((int) p.getAnalysisPreset(), juce::dontSendNotification);
+    presetBox.onChange = [this] {analysisSettingsChanged(); };
+    addAndMakeVisible(&presetBox);
+
+    hopBox.addItem("Preset hop", 1);
+    for (int i = 0; i < (int) std::size(hopChoicesSeconds); ++i)
+        hopBox.addItem("Hop " + juce::String(juce::roundToInt(hopChoicesSeconds[i] * 1000.0)) + " ms", i + 2);
+    hopBox.setSelectedId(1, juce::dontSendNotification);
+    for (int i = 0; i < (int) std::size(hopChoicesSeconds); ++i)
+        if (p.getOfflineHopSeconds() == hopChoicesSeconds[i])
+            hopBox.setSelectedId(i + 2, juce::dontSendNotification);
+    hopBox.addItem("Beat-aligned", beatsHopId);
+    if (p.isBeatSyncEnabled())
+        hopBox.setSelectedId(beatsHopId, juce::dontSendNotification);
+    hopBox.onChange = [this] {analysisSettingsChanged(); };
+    addAndMakeVisible(&hopBox);
+
+    chromaBox.addItemList(AnalysisSettings::getChromaNames(), (int) AnalysisSettings::Chroma::peaks);
+    chromaBox.setSelectedId((int) p.getChroma(), juce::dontSendNotification);
+    chromaBox.onChange = [this] {analysisSettingsChanged(); };
+    addAndMakeVisible(&chromaBox);
+
+    // Viterbi smoothing of the Chord ID result
+    smoothButton.setButtonText("Smooth");
+    smoothButton.setToggleState(p.isSmoothingEnabled(), juce::dontSendNotification);
+    smoothButton.onClick = [this] {analysisSettingsChanged(); };
+    addAndMakeVisible(&smoothButton);
+
+    // Number of chunks the file is split into, each analysed on its own thread
+    for (int threads = 1; threads <= p.getMaxAnalysisThreads(); ++threads)
+        analysisThreadsBox.addItem(juce::String(threads) + (threads == 1 ? " thread" : " threads"), threads);
+    analysisThreadsBox.setSelectedId(p.getMaxAnalysisThreads(), juce::dontSendNotification);
+    addAndMakeVisible(&analysisThreadsBox);
+
+    liveStatsLabel.setFont(12.0f);
+    addAndMakeVisible(liveStatsLabel);
+
+    instrumentationLabel.setFont(11.0f);
+    instrumentationLabel.setJustificationType(juce::Justification::topLeft);
+    addAndMakeVisible(instrumentationLabel);
+
+    dumpStatsButton.onClick = [this] {dumpStatsButtonClicked(); };
+    dumpStatsButton.setButtonText("Dump stats");
+    dumpStatsButton.setEnabled(Instrumentation::isEnabled());
+    addAndMakeVisible(&dumpStatsButton);
+
+    // The processor may already be playing or analysing a file
+    if (p.player.isPlaying())
+    {
+        state = Playing;
+        playButton.setEnabled(false);
+        stopButton.setEnabled(true);
+    }
+
+    updateAnalysisProgress();
+    startTimerHz(30);
 }
 
 
@@ -87,28 +221,43 @@ void VSTSamplerAudioProcessorEditor::resized()
     chordIdButton.setBounds(leftMargin + 300, topMargin + 120, buttonWidth, buttonHeight);
     chordLabel.setBounds(leftMargin + buttonWidth + 20, topMargin + 10, getWidth() * 0.5, buttonHeight);
 
+    analysisProgressBar.setBounds(leftMargin, topMargin + 80, getWidth() - 2 * leftMargin, 20);
+    presetBox.setBounds(leftMargin, topMargin + 45, buttonWidth + 40, 25);
+    hopBox.setBounds(leftMargin + 140, topMargin + 45, buttonWidth + 20, 25);
+    chromaBox.setBounds(leftMargin + 260, topMargin + 45, buttonWidth + 20, 25);
+
+    liveButton.setBounds(leftMargin, topMargin + 170, buttonWidth, buttonHeight);
+    liveSourceBox.setBounds(leftMargin + 100, topMargin + 170, buttonWidth + 20, buttonHeight);
+    smoothButton.setBounds(leftMargin + 215, topMargin + 170, buttonWidth, buttonHeight);
+    analysisThreadsBox.setBounds(leftMargin + 300, topMargin + 170, buttonWidth, buttonHeight);
+    liveStatsLabel.setBounds(leftMargin, topMargin + 205, getWidth() - 2 * leftMargin, 20);
+    instrumentationLabel.setBounds(leftMargin, topMargin + 230, getWidth() - 2 * leftMargin - buttonWidth - 10, 50);
+    dumpStatsButton.setBounds(getWidth() - leftMargin - buttonWidth, topMargin + 240, buttonWidth, buttonHeight);
+    samplesButton.setBounds(leftMargin, topMargin + 285, buttonWidth, buttonHeight);
+    samplerLabel.setBounds(leftMargin + buttonWidth + 10, topMargin + 285, getWidth() - 2 * leftMargin - buttonWidth - 10, buttonHeight);
+    readAheadBox.setBounds(leftMargin, topMargin + 320, buttonWidth + 40, 25);
+    resamplingBox.setBounds(leftMargin + 130, topMargin + 320, buttonWidth + 20, 25);
+    streamingLabel.setBounds(leftMargin + 240, topMargin + 320, getWidth() - 2 * leftMargin - 240, 25);
+    midiOutButton.setBounds(leftMargin, topMargin + 350, buttonWidth + 20, 25);
+    chordControllersButton.setBounds(leftMargin + 110, topMargin + 350, buttonWidth + 10, 25);
+    midiChannelBox.setBounds(leftMargin + 210, topMargin + 350, buttonWidth + 20, 25);
+    overview.setBounds(leftMargin, topMargin + 385, getWidth() - 2 * leftMargin, 90);
+    spectrumView.setBounds(leftMargin, topMargin + 485, getWidth() - 2 * leftMargin, getHeight() - topMargin - 485 - leftMargin);
+
 }
 
 
 void VSTSamplerAudioProcessorEditor::importButtonClicked()
 {
-    juce::FileChooser chooser("Choose audio", juce::File::getSpecialLocation(juce::File::userDesktopDirectory), "*.wav; *.mp3", true, false, nullptr);
-    if (chooser.browseForFileToOpen()) {
-        juce::File audioFile;
-        audioFile = chooser.getResult();
-        std::shared_ptr<juce::AudioFormatReader> tempReader(formatManager.createReaderFor(audioFile));
-        if (tempReader != nullptr) { //For when the new file is selected
-            std::unique_ptr < juce::AudioFormatReaderSource > tempSource(new juce::AudioFormatReaderSource(tempReader.get(), false));
-            p.transport.setSource(tempSource.get());
-            transportStateChanged(Stopped);
-            playSource.reset(tempSource.release());
-            reader = tempReader; // Assign tempReader to the member variable reader
-        }
+    juce::FileChooser chooser("Choose audio", juce::File::getSpecialLocation(juce::File::userDesktopDirectory), "*.wav; *.aif; *.aiff; *.mp3", true, false, nullptr);
+    if (chooser.browseForFileToOpen() && p.loadFile(chooser.getResult()))
+    {
+        chordLabel.setText("No Chord Detected", juce::dontSendNotification);
+        shownChord = -2;
+        transportStateChanged(Stopped);
     }
 }
 
-
-
 void VSTSamplerAudioProcessorEditor::playButtonClicked()
 {
     transportStateChanged(Starting);
@@ -128,7 +277,7 @@ void VSTSamplerAudioProcessorEditor::transportStateChanged(TransportState newSta
         switch (state) {
         case Stopped:
             playButton.setEnabled(true);
-            p.transport.setPosition(0.0);
+            p.player.setPosition(0.0);
             break;
 
         case Playing:
@@ -138,13 +287,13 @@ void VSTSamplerAudioProcessorEditor::transportStateChanged(TransportState newSta
         case Starting:
             stopButton.setEnabled(true);
             playButton.setEnabled(false);
-            p.transport.start();
+            p.player.start();
             break;
 
         case Stopping:
             playButton.setEnabled(true);
             stopButton.setEnabled(false);
-            p.transport.stop();
+            p.player.stop();
             break;
         }
     }
@@ -153,8 +302,8 @@ void VSTSamplerAudioProcessorEditor::transportStateChanged(TransportState newSta
 
 // Listening for changes - if there is a change, the state is changed to stopped
 void VSTSamplerAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster* source) {
-    if (source == &p.transport) {
-        if (p.transport.isPlaying()) {
+    if (source == &p.player) {
+        if (p.player.isPlaying()) {
             transportStateChanged(Playing);
         }
         else {
@@ -165,219 +314,193 @@ void VSTSamplerAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcas
 
 VSTSamplerAudioProcessorEditor::~VSTSamplerAudioProcessorEditor()
 {
+    // Playback and analysis belong to the processor, so they carry on without us
+    stopTimer();
+    p.player.removeChangeListener(this);
 }
 
-void VSTSamplerAudioProcessorEditor::chordDetectionButtonClicked() {
-    // Check whether the audio is loaded
-    if (playSource != nullptr && reader)
-    {
-        // FFT Parameters
-        static constexpr auto fftOrder = 12;            
-        static constexpr auto frameSize = 1 << fftOrder;
 
-        // FFT object
-        juce::dsp::FFT fft(fftOrder);
+void VSTSamplerAudioProcessorEditor::analysisSettingsChanged()
+{
+    const auto hopIndex = hopBox.getSelectedId() - 2;
+    const auto hop = juce::isPositiveAndBelow(hopIndex, (int) std::size(hopChoicesSeconds)) ? hopChoicesSeconds[hopIndex] : 0.0;
 
-        const int hopSize = frameSize / 2;
+    p.setSmoothingEnabled(smoothButton.getToggleState());
+    p.setBeatSyncEnabled(hopBox.getSelectedId() == beatsHopId);
+    p.setAnalysisSettings((AnalysisSettings::Preset) presetBox.getSelectedId(), hop,
+                          (AnalysisSettings::Chroma) chromaBox.getSelectedId());
 
-        // Buffer to store the audio data
-        juce::AudioBuffer<float> audioBuffer(2, frameSize);
+    // Results for the old settings no longer apply
+    p.refreshAnalysis();
+    updateAnalysisProgress();
+}
 
-        // Buffer to store the time-domain data
-        std::vector<float> timeDomainData(frameSize*2);
-        std::fill(timeDomainData.begin(), timeDomainData.end(), 0.0f);
+void VSTSamplerAudioProcessorEditor::liveButtonClicked()
+{
+    p.setLiveDetectionEnabled(liveButton.getToggleState());
+    shownChord = -2;
+}
 
-        // Buffer to store the magnitudes of the frequency-domain data
-        std::vector<float> magnitudes(frameSize / 2);
+// Polls the live detector and the analysis, neither of which ever notifies us
+void VSTSamplerAudioProcessorEditor::timerCallback()
+{
+    updateAnalysisProgress();
 
-        // Buffer to store the windowing function
-        std::vector<float> window(frameSize);
+    // The overlay only needs to change a few times a second
+    if (++timerTicks % 10 == 0)
+    {
+        updateInstrumentation();
+        updateSamplerLabel();
+        updateStreamingLabel();
+    }
 
-        // Hamming window 
-        std::vector<float> hammingWindow(frameSize);
-        for (int i = 0; i < frameSize; ++i) {
-            hammingWindow[i] = 0.54 - (0.46 * cos((2 * juce::MathConstants<float>::pi * i) / frameSize - 1));
-        }
+    if (! p.liveChordDetector.isEnabled())
+    {
+        updatePlayheadChord();
+        return;
+    }
 
-        // Blackman-Harris window 
-        std::vector<float> blackmanHarrisWindow(frameSize);
-        for (int i = 0; i < frameSize; ++i) {
-            blackmanHarrisWindow[i] = 0.35875 -
-                0.48829 * cos((2 * juce::MathConstants<float>::pi * i) / (frameSize - 1)) +
-                0.14128 * cos((4 * juce::MathConstants<float>::pi * i) / (frameSize - 1)) -
-                0.01168 * cos((6 * juce::MathConstants<float>::pi * i) / (frameSize - 1));
-        }
+    const auto snapshot = p.liveChordDetector.getCurrentChord();
+    if (snapshot.chordIndex >= 0)
+        chordLabel.setText(ChordDetection::getChordName(snapshot.chordIndex), juce::dontSendNotification);
 
-        // Hann window 
-        std::vector<float> hannWindow(frameSize);
-        for (int i = 0; i < frameSize; ++i) {
-            hannWindow[i] = 0.5f * (1 - cos((2 * juce::MathConstants<float>::pi * i) / (frameSize - 1)));
-        }
+    const auto stats = p.liveChordDetector.getStats();
+    liveStatsLabel.setText("Frames " + juce::String(stats.framesAnalysed)
+                           + "  skipped " + juce::String(stats.framesSkipped)
+                           + "  dropped " + juce::String(stats.samplesDropped)
+                           + "  latency " + juce::String(stats.latencyMs, 1) + " ms (max " + juce::String(stats.maxLatencyMs, 1) + ")",
+                           juce::dontSendNotification);
+}
 
-        auto currentPosition = playSource->getNextReadPosition();
-
-        sampleRate = reader->sampleRate;
-
-        float stepSizeInSeconds = 0.5f;
-        int stepSize = static_cast<int>(sampleRate * stepSizeInSeconds);
-
-        // Iterate through the audio in chunks of stepSize
-        for (int position = 0; position + frameSize <= playSource->getTotalLength(); position += stepSize)
-
-        {
-            // Set the read position for playSource
-            playSource->setNextReadPosition(position);
-
-            double timestamp = static_cast<double>(position) / sampleRate;
-            DBG("Timestamp: " << timestamp);
-
-            // Read the audio-data from source into the buffer
-            playSource->getNextAudioBlock(juce::AudioSourceChannelInfo(audioBuffer));
-            
-            // Apply window
-            std::vector<float> channelData(frameSize, 0.0f);
-
-            for (int channel = 0; channel < 2; ++channel)
-            {
-                for (int i = 0; i < frameSize; ++i)
-                {
-                    channelData[i] = audioBuffer.getWritePointer(channel)[i] * hannWindow[i];
-                }
-
-                for (int i = 0; i < frameSize; ++i)
-                {
-                    timeDomainData[i] += channelData[i];
-                }
-            }
-
-
-            // Perform FFT on audio-data
-            fft.performFrequencyOnlyForwardTransform(timeDomainData.data());
-
-            // Extract magnitudes
-            
-            for (int i = 0; i < frameSize / 2; ++i)
-            {
-                magnitudes[i] = timeDomainData[i];
-            }
-
-            // Saving magnitudes for visual analisys
-            if (timestamp == 1.0) {
-                
-                std::ofstream file("magnitudes.csv");
-                for (const auto& magnitude : magnitudes)
-                {
-                    file << magnitude << ",";
-                }
-                file.close();
-            }
-
-            // Analyze frequency data to detect chord
-            juce::String chord = detectChord(magnitudes);
-
-            DBG("Detected Chord: " << chord);
-            
-            // Update chord label text
-            if (chord.isNotEmpty()) {
-                chordLabel.setText(chord, juce::dontSendNotification);
-                DBG("Updated Chord Label: " << chord);
-            }
-            else
-            {
-                DBG("No chord detected");
-            }
-
-            if (position + frameSize + hopSize > playSource->getTotalLength())
-            {
-                //break;
-            }
-        }
+void VSTSamplerAudioProcessorEditor::chordDetectionButtonClicked() {
+    // A second click cancels the running analysis
+    if (auto* analysis = p.getAnalysis(); analysis != nullptr && ! analysis->isFinished())
+        p.cancelAnalysis();
+    else
+        p.startAnalysis(analysisThreadsBox.getSelectedId());
 
-        // Restore to original playSource position
-        playSource->setNextReadPosition(currentPosition);
-        DBG("FINISH");
+    updateAnalysisProgress();
+}
 
+// Picks up whatever the background analysis has finished since the last tick
+void VSTSamplerAudioProcessorEditor::updateAnalysisProgress()
+{
+    const auto* analysis = p.getAnalysis();
+
+    if (analysis == nullptr)
+    {
+        analysisProgress = p.getTimeline() != nullptr ? 1.0 : 0.0;
+        chordIdButton.setButtonText("Chord ID");
+        return;
+    }
+
+    analysisProgress = analysis->getProgress();
+    chordIdButton.setButtonText(analysis->isFinished() ? "Chord ID" : "Cancel");
+
+    if (analysis->isFinished())
+    {
+        if (analysis->failedToOpen())
+            chordLabel.setText("Couldn't read file", juce::dontSendNotification);
+
+        analysisProgress = analysis->wasCancelled() ? 0.0 : 1.0;
     }
 }
 
+// Shows the chord under the player's position: from the timeline once there
+// is one, or straight from the frames that are ready while the analysis runs
+void VSTSamplerAudioProcessorEditor::updatePlayheadChord()
+{
+    const double position = p.player.getCurrentPosition();
+    const auto* timeline = p.getTimeline();
+    const auto* analysis = p.getAnalysis();
+    int chord = -1;
+
+    // A new result, or none at all, must replace whatever is shown
+    if (timeline != shownTimeline)
+    {
+        shownTimeline = timeline;
+        shownChord = -2;
+
+        if (timeline == nullptr)
+            chordLabel.setText("No Chord Detected", juce::dontSendNotification);
+    }
 
+    if (timeline != nullptr)
+    {
+        chord = timeline->getChordAt(position);
+    }
+    else if (analysis != nullptr && analysis->getNumFramesReady() > 0)
+    {
+        // Past the last frame that is ready, the chord isn't known yet
+        const auto frame = analysis->getFrameIndexAt((juce::int64) (position * analysis->getSampleRate()));
+        if (frame < 0 || (frame == analysis->getNumFramesReady() - 1 && ! analysis->isFinished()))
+            return;
 
+        chord = analysis->getFrame(frame).chordIndex;
+    }
+    else
+    {
+        return;
+    }
 
-float dotProduct(const std::vector<float>& a, const std::vector<float>& b) {
-    float result = 0.0f;
-    for (size_t i = 0; i < a.size(); ++i) {
-        result += a[i] * b[i];
+    if (chord != shownChord)
+    {
+        shownChord = chord;
+        chordLabel.setText(chord >= 0 ? ChordDetection::getChordName(chord) : juce::String("No Chord Detected"), juce::dontSendNotification);
     }
-    return result;
 }
 
+void VSTSamplerAudioProcessorEditor::updateInstrumentation()
+{
+    instrumentationLabel.setText(Instrumentation::getAnalysisCounters().getSummary() + "\n" + p.blockStats.getSummary(),
+                                 juce::dontSendNotification);
+}
 
-juce::String VSTSamplerAudioProcessorEditor::detectChord(const std::vector<float>& magnitudes) {
-    // Note names and chord templates
-    const std::vector<juce::String> noteNames = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
-    const std::vector<std::pair<std::vector<int>, juce::String>> chordTemplates = {
-        {{0, 4, 7}, "Major"},
-        {{0, 3, 7}, "Minor"},
-        {{0, 4, 7, 11}, "Major 7th"}
-        // More can be added
-    };
+void VSTSamplerAudioProcessorEditor::samplesButtonClicked()
+{
+    juce::FileChooser chooser("Choose samples (the root note is read from names like \"Piano C4\")",
+                              juce::File::getSpecialLocation(juce::File::userDesktopDirectory), "*.wav; *.aif; *.aiff; *.flac", true, false, nullptr);
+    if (! chooser.browseForMultipleFilesToOpen())
+        return;
 
-    // PCP
-    std::vector<float> pitchClassProfile(12, 0.0f);
-    const std::vector<float> noteFrequencies = { 16.35, 17.32, 18.35, 19.45, 20.60, 21.83, 23.12, 24.50, 25.96, 27.50, 29.14, 30.87 };
-    std::vector<float> logFrequencies(noteFrequencies.size());
-    std::transform(noteFrequencies.begin(), noteFrequencies.end(), logFrequencies.begin(), [](float freq) { return std::log2(freq); });
-
-    for (int i = 1; i < magnitudes.size() - 1; ++i) {
-        float mag = magnitudes[i];
-        if (mag > magnitudes[i - 1] && mag > magnitudes[i + 1])  // Peak detected
-        {
-            // Convert peak index to frequency
-            float freq = static_cast<float>(i) * sampleRate / (2 * magnitudes.size());
-            float logFreq = std::log2(freq);
-
-            for (int octave = 0; octave < 8; ++octave) {
-                for (int nf = 0; nf < 12; ++nf) {
-                    float lowerBoundLog = (logFrequencies[nf] + logFrequencies[(nf - 1 + 12) % 12]) / 2 + octave;
-                    float upperBoundLog = (logFrequencies[nf] + logFrequencies[(nf + 1) % 12]) / 2 + octave;
-                    if (logFreq > lowerBoundLog && logFreq <= upperBoundLog) {
-                        pitchClassProfile[nf] += mag;
-                    }
-                }
-            }
-        }
-    }
+    juce::StringArray errors;
+    if (! p.loadSamples(chooser.getResults(), &errors) || ! errors.isEmpty())
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Samples", errors.joinIntoString("\n"));
 
-/*
-    // Normalize PCP
-    float maxValue = *std::max_element(pitchClassProfile.begin(), pitchClassProfile.end());
-    for (int i = 0; i < 12; ++i)
+    updateSamplerLabel();
+}
+
+void VSTSamplerAudioProcessorEditor::updateSamplerLabel()
+{
+    const auto pool = p.sampler.getSamplePool();
+
+    if (pool == nullptr)
     {
-        pitchClassProfile[i] /= maxValue;
+        samplerLabel.setText("No samples loaded: MIDI input plays them", juce::dontSendNotification);
+        return;
     }
-*/
- 
-    juce::String bestChord;
-    float bestScore = 0.0f;
 
-    // Compare PCP and chord templates and find the best match
-    for (int rootNote = 0; rootNote < 12; ++rootNote)
+    samplerLabel.setText(juce::String(pool->getNumSamples()) + (pool->getNumSamples() == 1 ? " sample, " : " samples, ")
+                         + juce::String(p.sampler.getNumActiveVoices()) + " of " + juce::String(SamplerEngine::maxVoices) + " voices",
+                         juce::dontSendNotification);
+}
+
+void VSTSamplerAudioProcessorEditor::updateStreamingLabel()
+{
+    if (p.player.getLoadedFile() == nullptr)
     {
-        for (const auto& templateChord : chordTemplates)
-        {
-            float score = 0.0f;
-            for (int note : templateChord.first)
-            {
-                score += pitchClassProfile[(rootNote + note) % 12];
-            }
-
-            if (score > bestScore)
-            {
-                bestScore = score;
-                bestChord = noteNames[rootNote] + " " + templateChord.second;
-            }
-        }
+        streamingLabel.setText({}, juce::dontSendNotification);
+        return;
     }
 
-    return bestChord;
-}
\ No newline at end of file
+    streamingLabel.setText("Buffer " + juce::String(juce::roundToInt(p.player.getBufferFillLevel() * 100.0f)) + "%, "
+                           + juce::String(p.player.getNumUnderruns()) + " underruns",
+                           juce::dontSendNotification);
+}
+
+void VSTSamplerAudioProcessorEditor::dumpStatsButtonClicked()
+{
+    juce::FileChooser chooser("Save stats", juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("vst-sampler-stats.txt"), "*.txt", true, false, nullptr);
+    if (chooser.browseForFileToSave(true))
+        Instrumentation::dumpToFile(chooser.getResult(), &p.blockStats);
+}
@@ -10,12 +10,15 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "Gui/LiveSpectrumView.h"
+#include "Gui/WaveformOverview.h"
 
 //==============================================================================
 /**
 */
 class VSTSamplerAudioProcessorEditor  : public juce::AudioProcessorEditor,
-                                        public juce::ChangeListener
+                                        public juce::ChangeListener,
+                                        private juce::Timer
 {
 public:
     VSTSamplerAudioProcessorEditor (VSTSamplerAudioProcessor& p);
@@ -25,12 +28,6 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
-    double getSampleRate() const
-    {
-        return getSampleRate();
-    }
-
-
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -47,8 +44,6 @@ private:
 
     VSTSamplerAudioProcessor& p;
 
-    double sampleRate;
-
     juce::TextButton importButton;
     juce::TextButton playButton;
     juce::TextButton stopButton;
@@ -56,27 +51,60 @@ private:
 
     juce::TextButton chordIdButton;
     juce::Label chordLabel;
-    
-    void importButtonClicked();
 
+    // The label shows the chord at the playhead, from the processor's analysis
+    const ChordTimeline* shownTimeline = nullptr;
+    int shownChord = -2;
 
-    void playButtonClicked();
-    void stopButtonClicked();
-    void transportStateChanged(TransportState newState);
-    void changeListenerCallback (juce::ChangeBroadcaster* source) override;
-    void chordDetectionButtonClicked();
+    juce::ComboBox analysisThreadsBox;
+    double analysisProgress = 0.0;
+    juce::ProgressBar analysisProgressBar { analysisProgress };
 
+    juce::ComboBox presetBox, hopBox, chromaBox;
+    static constexpr double hopChoicesSeconds[] = { 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0 };
+    static constexpr int beatsHopId = (int) std::size(hopChoicesSeconds) + 2;   // one chord per tracked beat, for alignment rather than speed
+    juce::ToggleButton smoothButton;
 
-    juce::String detectChord(const std::vector<float>& frequencyData);
+    juce::ToggleButton liveButton;
+    juce::ComboBox liveSourceBox;
 
+    // Live chords as MIDI notes (and optionally controllers) on a channel
+    juce::ToggleButton midiOutButton, chordControllersButton;
+    juce::ComboBox midiChannelBox;
 
-    juce::AudioFormatManager formatManager;
-    
+    WaveformOverview overview { p.getThumbnail(), p.player, [this] { return p.getTimeline(); } };
+    LiveSpectrumView spectrumView { p.liveChordDetector };
+    juce::Label liveStatsLabel;
+
+    juce::TextButton samplesButton;
+    juce::Label samplerLabel;
 
-    std::shared_ptr<juce::AudioFormatReader> reader;
+    // Decoding runs ahead of playback on a background thread; this sets how far
+    juce::ComboBox readAheadBox, resamplingBox;
+    static constexpr double readAheadChoicesSeconds[] = { 0.25, 0.5, 1.0, 2.0, 4.0 };
+    juce::Label streamingLabel;
 
+    juce::Label instrumentationLabel;
+    juce::TextButton dumpStatsButton;
+    int timerTicks = 0;
+    
+    void importButtonClicked();
+    void analysisSettingsChanged();
 
+    void playButtonClicked();
+    void stopButtonClicked();
+    void transportStateChanged(TransportState newState);
+    void changeListenerCallback (juce::ChangeBroadcaster* source) override;
+    void chordDetectionButtonClicked();
+    void updateAnalysisProgress();
+    void updatePlayheadChord();
+    void liveButtonClicked();
+    void dumpStatsButtonClicked();
+    void samplesButtonClicked();
+    void updateSamplerLabel();
+    void updateStreamingLabel();
+    void updateInstrumentation();
+    void timerCallback() override;
 
-    std::unique_ptr<juce::AudioFormatReaderSource> playSource;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VSTSamplerAudioProcessorEditor)
 };
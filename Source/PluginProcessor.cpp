@@ -22,10 +22,16 @@ VSTSamplerAudioProcessor::VSTSamplerAudioProcessor()
                        )
 #endif
 {
+    formatManager.registerBasicFormats();
+    player.addChangeListener(this);
 }
 
 VSTSamplerAudioProcessor::~VSTSamplerAudioProcessor()
 {
+    player.removeChangeListener(this);
+
+    // Its completion callback publishes to our mailbox and cache
+    cancelAnalysis();
 }
 
 //==============================================================================
@@ -93,13 +99,29 @@ void VSTSamplerAudioProcessor::changeProgramName (int index, const juce::String&
 //==============================================================================
 void VSTSamplerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    transport.prepareToPlay(sampleRate, samplesPerBlock);
+    player.prepareToPlay(sampleRate, samplesPerBlock);
+    sampler.prepare(sampleRate, samplesPerBlock);
+    chordMidiOutput.reset();
+    liveChordDetector.prepare(sampleRate, samplesPerBlock, getLiveSettings());
+
+    // Enough for the longest preset's latency
+    const auto longest = AnalysisSettings::fromPreset(AnalysisSettings::Preset::highResolution).withHopSeconds(0.0);
+    outputDelay.setMaximumDelayInSamples(longest.getFrameSize() / 2 + longest.getHopSize(sampleRate));
+    outputDelay.prepare({ sampleRate, (juce::uint32) samplesPerBlock, (juce::uint32) getTotalNumOutputChannels() });
+    delayFadeLength = juce::jmax(1, juce::roundToInt(0.01 * sampleRate));
+    delayFadeRemaining = 0;
+
+    // Nothing is playing yet, so the delay can start where it belongs
+    updateLatency();
+    appliedDelaySamples = outputDelaySamples.load();
 }
 
 void VSTSamplerAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    player.releaseResources();
+    liveChordDetector.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -131,6 +153,11 @@ bool VSTSamplerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
 void VSTSamplerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    VST_SAMPLER_SCOPED_BLOCK (blockStats, buffer.getNumSamples(), getSampleRate());
+
+    // Whatever the player and sampler pick up here stays alive until the block ends
+    const DeferredRelease::CallbackScope callbackScope(deferredRelease);
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -143,9 +170,86 @@ void VSTSamplerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
+    // Beat-synchronous analysis keeps to the host's tempo, but only one it is
+    // actually playing at: a stopped or empty project still reports a default
+    if (auto* playHead = getPlayHead())
+        if (const auto position = playHead->getPosition(); position.hasValue() && position->getIsPlaying())
+            if (const auto bpm = position->getBpm())
+                hostTempo.store(*bpm, std::memory_order_relaxed);
+
+    // The player overwrites the buffer, so live input has to be captured first
+    const auto source = liveSource.load(std::memory_order_relaxed);
+    const auto liveBlockStart = liveChordDetector.getNumSamplesPushed();
+
+    if (source == LiveSource::input)
+        liveChordDetector.pushSamples(buffer, totalNumInputChannels);
+
+    // Retrieve audio data from the imported file
+    player.getNextAudioBlock(juce::AudioSourceChannelInfo(buffer));
+
+    // The sampler's voices are mixed on top, so live detection hears them too
+    sampler.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+
+    if (source == LiveSource::transport)
+        liveChordDetector.pushSamples(buffer, totalNumOutputChannels);
 
-    // Retrieve audio data from transport source
-    transport.getNextAudioBlock(juce::AudioSourceChannelInfo(buffer));
+    // Added after the sampler has read the block's MIDI, at the offsets that
+    // line up with the delayed audio below
+    chordMidiOutput.beginBlock(midiMessages, liveChordDetector.isEnabled());
+    liveChordDetector.popChordChanges(liveBlockStart, buffer.getNumSamples(), [this, &midiMessages] (int sampleOffset, int chordIndex)
+    {
+        chordMidiOutput.writeChordChange(midiMessages, sampleOffset, chordIndex);
+    });
+
+    // Delay what the host hears by the latency it has been told about. The line
+    // is fed even without a delay, so a change can crossfade from the old delay
+    // to the new one over 10 ms instead of jumping to a cleared line.
+    const auto delaySamples = outputDelaySamples.load(std::memory_order_relaxed);
+
+    if (delaySamples != appliedDelaySamples)
+    {
+        fadeFromDelaySamples = appliedDelaySamples;
+        appliedDelaySamples = delaySamples;
+        delayFadeRemaining = delayFadeLength;
+    }
+
+    if (totalNumOutputChannels > 0 && delayFadeRemaining == 0)
+    {
+        auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, (size_t) totalNumOutputChannels);
+        outputDelay.setDelay((float) appliedDelaySamples);
+        outputDelay.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+    else if (totalNumOutputChannels > 0)
+    {
+        const int numSamples = buffer.getNumSamples();
+        const int numFading = juce::jmin(numSamples, delayFadeRemaining);
+
+        for (int channel = 0; channel < totalNumOutputChannels; ++channel)
+        {
+            auto* data = buffer.getWritePointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                outputDelay.pushSample(channel, data[i]);
+
+                // While fading, both delays are read before the read pointer moves on
+                const auto delayed = outputDelay.popSample(channel, (float) appliedDelaySamples, i >= numFading);
+
+                if (i < numFading)
+                {
+                    const auto previous = outputDelay.popSample(channel, (float) fadeFromDelaySamples);
+                    const auto weight = (float) (delayFadeRemaining - i) / (float) delayFadeLength;
+                    data[i] = delayed + weight * (previous - delayed);
+                }
+                else
+                {
+                    data[i] = delayed;
+                }
+            }
+        }
+
+        delayFadeRemaining -= numFading;
+    }
 
 
     // This is the place where you'd normally do the guts of your plugin's
@@ -170,21 +274,336 @@ bool VSTSamplerAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* VSTSamplerAudioProcessor::createEditor()
 {
+    editorOpen = true;
+    updateAnalysisPriority();
     return new VSTSamplerAudioProcessorEditor (*this);
 }
 
+void VSTSamplerAudioProcessor::editorBeingDeleted(juce::AudioProcessorEditor* editor) noexcept
+{
+    AudioProcessor::editorBeingDeleted(editor);
+    editorOpen = false;
+    updateAnalysisPriority();
+}
+
+void VSTSamplerAudioProcessor::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+    // The player started or stopped
+    updateAnalysisPriority();
+}
+
+void VSTSamplerAudioProcessor::updateAnalysisPriority()
+{
+    using Priority = SharedAnalysisService::Priority;
+
+    analysisClient.setPriority(player.isPlaying() ? Priority::playing
+                                                  : editorOpen ? Priority::visible : Priority::background);
+}
+
 //==============================================================================
 void VSTSamplerAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // Only a reference to the file is stored; its analysis lives in the cache
+    const auto state = getLoadedFileState();
+
+    juce::XmlElement xml("VSTSamplerState");
+    xml.setAttribute("file", state.file.getFullPathName());
+    xml.setAttribute("fileModified", juce::String(state.modificationTime.toMilliseconds()));
+    xml.setAttribute("analysisCacheKey", state.analysisCacheKey);
+    xml.setAttribute("analysisPreset", (int) getAnalysisPreset());
+    xml.setAttribute("offlineHopSeconds", getOfflineHopSeconds());
+    xml.setAttribute("chroma", (int) getChroma());
+    xml.setAttribute("smoothing", isSmoothingEnabled());
+    xml.setAttribute("beatSync", isBeatSyncEnabled());
+    xml.setAttribute("readAheadSeconds", getReadAheadSeconds());
+    xml.setAttribute("resamplingQuality", (int) getResamplingQuality());
+    xml.setAttribute("chordMidiOutput", chordMidiOutput.isEnabled());
+    xml.setAttribute("chordControllers", chordMidiOutput.areControllersEnabled());
+    xml.setAttribute("chordMidiChannel", chordMidiOutput.getChannel());
+
+    auto* samples = xml.createNewChildElement("Samples");
+    for (auto& file : sampleFiles)
+        samples->createNewChildElement("Sample")->setAttribute("file", file.getFullPathName());
+
+    copyXmlToBinary(xml, destData);
 }
 
 void VSTSamplerAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    // The file (and its cached analysis) is reloaded once the settings it depends on are back
+    if (auto xml = getXmlFromBinary(data, sizeInBytes))
+    {
+        if (xml->hasTagName("VSTSamplerState"))
+        {
+            LoadedFileState state;
+            const auto path = xml->getStringAttribute("file");
+
+            if (juce::File::isAbsolutePath(path))
+                state.file = juce::File(path);
+
+            state.modificationTime = juce::Time(xml->getStringAttribute("fileModified").getLargeIntValue());
+            state.analysisCacheKey = xml->getStringAttribute("analysisCacheKey");
+            setLoadedFileState(state);
+
+            auto preset = xml->getIntAttribute("analysisPreset", (int) AnalysisSettings::Preset::standard);
+            if (preset < (int) AnalysisSettings::Preset::standard || preset > (int) AnalysisSettings::Preset::highResolution)
+                preset = (int) AnalysisSettings::Preset::standard;
+
+            auto chromaMethod = xml->getIntAttribute("chroma", (int) AnalysisSettings::Chroma::peaks);
+            if (chromaMethod != (int) AnalysisSettings::Chroma::constantQ)
+                chromaMethod = (int) AnalysisSettings::Chroma::peaks;
+
+            auto quality = xml->getIntAttribute("resamplingQuality", (int) PolyphaseResampler::Quality::normal);
+            if (quality < (int) PolyphaseResampler::Quality::draft || quality > (int) PolyphaseResampler::Quality::high)
+                quality = (int) PolyphaseResampler::Quality::normal;
+
+            // Samples are resampled as they load, at this quality
+            setResamplingQuality((PolyphaseResampler::Quality) quality);
+
+            juce::Array<juce::File> sampleFilesToLoad;
+
+            if (auto* samples = xml->getChildByName("Samples"))
+                for (auto* sample : samples->getChildWithTagNameIterator("Sample"))
+                    if (juce::File::isAbsolutePath(sample->getStringAttribute("file")))
+                        sampleFilesToLoad.add(juce::File(sample->getStringAttribute("file")));
+
+            setSmoothingEnabled(xml->getBoolAttribute("smoothing", false));
+            setBeatSyncEnabled(xml->getBoolAttribute("beatSync", false));
+            chordMidiOutput.setEnabled(xml->getBoolAttribute("chordMidiOutput", false));
+            chordMidiOutput.setControllersEnabled(xml->getBoolAttribute("chordControllers", false));
+            chordMidiOutput.setChannel(xml->getIntAttribute("chordMidiChannel", 1));
+            setReadAheadSeconds(juce::jlimit(0.05, 10.0, xml->getDoubleAttribute("readAheadSeconds", ReadAheadAudioSource::defaultReadAheadSeconds)));
+            setAnalysisSettings((AnalysisSettings::Preset) preset, xml->getDoubleAttribute("offlineHopSeconds", 0.0),
+                                (AnalysisSettings::Chroma) chromaMethod);
+
+            auto loadFiles = [this, sampleFilesToLoad, file = state.file]
+            {
+                if (! sampleFilesToLoad.isEmpty())
+                    loadSamples(sampleFilesToLoad);
+
+                if (file.existsAsFile())
+                    loadFile(file);
+            };
+
+            // Loading swaps the sample pool and the thumbnail source, which belong to the
+            // message thread, and some hosts restore state from another one
+            if (juce::MessageManager::existsAndIsCurrentThread())
+            {
+                loadFiles();
+            }
+            else
+            {
+                juce::MessageManager::callAsync([processor = juce::WeakReference<VSTSamplerAudioProcessor>(this), loadFiles]
+                {
+                    if (processor != nullptr)
+                        loadFiles();
+                });
+            }
+        }
+    }
+}
+
+void VSTSamplerAudioProcessor::setLiveDetectionEnabled(bool shouldBeEnabled)
+{
+    liveChordDetector.setEnabled(shouldBeEnabled);
+    liveChordDetector.resetStats();
+    updateLatency();
+}
+
+void VSTSamplerAudioProcessor::setAnalysisSettings(AnalysisSettings::Preset newPreset, double newOfflineHopSeconds,
+                                                   AnalysisSettings::Chroma newChroma)
+{
+    offlineHopSeconds.store(newOfflineHopSeconds);
+
+    if (newPreset == analysisPreset.load() && newChroma == chroma.load())
+        return;
+
+    analysisPreset.store(newPreset);
+    chroma.store(newChroma);
+
+    // The detector's buffers are resized, so the audio thread must not be pushing meanwhile
+    if (getSampleRate() > 0.0)
+    {
+        suspendProcessing(true);
+        liveChordDetector.prepare(getSampleRate(), getBlockSize(), getLiveSettings());
+        suspendProcessing(false);
+    }
+
+    updateLatency();
+}
+
+bool VSTSamplerAudioProcessor::loadSamples(const juce::Array<juce::File>& files, juce::StringArray* errors)
+{
+    auto pool = SamplePool::loadFromFiles(formatManager, files, errors, getSampleRate(), getResamplingQuality());
+
+    if (pool == nullptr)
+        return false;
+
+    // The audio thread may still be playing the old pool until its block ends
+    deferredRelease.retire(sampler.setSamplePool(std::move(pool)));
+
+    sampleFiles = files;
+    return true;
+}
+
+bool VSTSamplerAudioProcessor::loadFile(const juce::File& file)
+{
+    if (! player.load(formatManager, file, getReadAheadSeconds(), getResamplingQuality()))
+        return false;
+
+    // Hashed with the modification time, so an edited file gets a new overview
+    thumbnail.setSource(new juce::FileInputSource(file, true));
+
+    cancelAnalysis();
+    lookUpCachedAnalysis();
+    return true;
+}
+
+juce::File VSTSamplerAudioProcessor::getLoadedFile() const
+{
+    const auto loaded = player.getLoadedFile();
+    return loaded != nullptr ? loaded->file : juce::File();
+}
+
+void VSTSamplerAudioProcessor::reloadPlaybackFile()
+{
+    const auto loaded = player.getLoadedFile();
+
+    if (loaded == nullptr)
+        return;
+
+    const auto wasPlaying = player.isPlaying();
+
+    if (player.load(formatManager, loaded->file, getReadAheadSeconds(), getResamplingQuality(), player.getCurrentPosition())
+         && wasPlaying)
+        player.start();
+}
+
+AnalysisSettings VSTSamplerAudioProcessor::getOfflineAnalysisSettings() const
+{
+    const auto settings = AnalysisSettings::fromPreset(analysisPreset.load())
+                              .withChroma(chroma.load())
+                              .withSmoothing(smoothing.load())
+                              .withBeatSync(beatSync.load(), hostTempo.load());
+    const auto hop = offlineHopSeconds.load();
+    return hop > 0.0 ? settings.withHopSeconds(hop) : settings;
+}
+
+bool VSTSamplerAudioProcessor::startAnalysis(int numChunks)
+{
+    const auto file = getLoadedFile();
+
+    if (! file.existsAsFile())
+        return false;
+
+    cancelAnalysis();
+    analysis = std::make_unique<OfflineChordAnalysis>(file, getOfflineAnalysisSettings());
+
+    // Keyed by the settings it actually runs with: the host tempo may have
+    // changed since the key was looked up
+    auto fileState = getLoadedFileState();
+
+    if (fileState.analysisCacheKey.isNotEmpty())
+    {
+        fileState.analysisCacheKey = ChordAnalysisCache::withParameters(fileState.analysisCacheKey,
+                                                                        OfflineChordAnalysis::getParameterSignature(analysis->getSettings()));
+        setLoadedFileState(fileState);
+    }
+
+    // Called on a pool thread once every chunk has finished. The analysis is
+    // always cancelled and destroyed before the mailbox and the cache.
+    analysis->onComplete = [this, key = fileState.analysisCacheKey] (const OfflineChordAnalysis& finished)
+    {
+        analysisCache.store(key, ChordAnalysisCache::createEntry(finished));
+        timelineMailbox.publish(finished.createTimeline());
+    };
+
+    analysis->start(analysisClient, numChunks);
+    return true;
+}
+
+void VSTSamplerAudioProcessor::cancelAnalysis()
+{
+    if (analysis != nullptr)
+    {
+        analysis->cancel();
+        analysis.reset();   // waits for the job to stop
+    }
+}
+
+void VSTSamplerAudioProcessor::refreshAnalysis()
+{
+    if (player.getLoadedFile() == nullptr)
+        return;
+
+    cancelAnalysis();
+    lookUpCachedAnalysis();
+}
+
+const ChordTimeline* VSTSamplerAudioProcessor::getTimeline()
+{
+    if (auto published = timelineMailbox.take())
+        timeline = std::move(published);
+
+    return timeline.get();
+}
+
+// Shows the cached analysis of the loaded file under the current settings, if there is one
+void VSTSamplerAudioProcessor::lookUpCachedAnalysis()
+{
+    timelineMailbox.take();
+    timeline.reset();
+
+    // Reuse the saved key if the file hasn't changed since, otherwise hash it again
+    const auto file = getLoadedFile();
+    const auto signature = OfflineChordAnalysis::getParameterSignature(getOfflineAnalysisSettings());
+    auto fileState = getLoadedFileState();
+
+    if (fileState.file != file
+         || fileState.modificationTime != file.getLastModificationTime()
+         || fileState.analysisCacheKey.isEmpty())
+    {
+        fileState.file = file;
+        fileState.modificationTime = file.getLastModificationTime();
+        fileState.analysisCacheKey = ChordAnalysisCache::createKey(file, signature);
+        setLoadedFileState(fileState);
+    }
+    else if (! ChordAnalysisCache::keyMatchesParameters(fileState.analysisCacheKey, signature))
+    {
+        fileState.analysisCacheKey = ChordAnalysisCache::withParameters(fileState.analysisCacheKey, signature);
+        setLoadedFileState(fileState);
+    }
+
+    ChordAnalysisCache::Entry entry;
+    if (analysisCache.load(fileState.analysisCacheKey, entry))
+        timeline = OfflineChordAnalysis::createTimeline(entry.frames.data(), (int) entry.frames.size(), entry.sampleRate);
+}
+
+AnalysisSettings VSTSamplerAudioProcessor::getLiveSettings() const
+{
+    // Live frames always overlap by half, whatever the offline hop is
+    return AnalysisSettings::fromPreset(analysisPreset.load())
+               .withHopSeconds(0.0)
+               .withChroma(chroma.load());
+}
+
+void VSTSamplerAudioProcessor::updateLatency()
+{
+    const int latency = liveChordDetector.isEnabled() ? liveChordDetector.getLatencySamples() : 0;
+    outputDelaySamples.store(latency);
+    setLatencySamples(latency);
+}
+
+void VSTSamplerAudioProcessor::setLoadedFileState(const LoadedFileState& newState)
+{
+    const juce::ScopedLock sl(loadedFileLock);
+    loadedFileState = newState;
+}
+
+VSTSamplerAudioProcessor::LoadedFileState VSTSamplerAudioProcessor::getLoadedFileState() const
+{
+    const juce::ScopedLock sl(loadedFileLock);
+    return loadedFileState;
 }
 
 //==============================================================================
@@ -9,11 +9,24 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Analysis/ChordAnalysisCache.h"
+#include "Analysis/Instrumentation.h"
+#include "Analysis/LiveChordDetector.h"
+#include "Analysis/OfflineChordAnalysis.h"
+#include "Analysis/SharedAnalysisService.h"
+#include "Gui/PersistentThumbnailCache.h"
+#include "Midi/ChordMidiOutput.h"
+#include "Playback/DeferredRelease.h"
+#include "Playback/FilePlayer.h"
+#include "Playback/PolyphaseResampler.h"
+#include "Playback/ReadAheadAudioSource.h"
+#include "Sampler/SamplerEngine.h"
 
 //==============================================================================
 /**
 */
-class VSTSamplerAudioProcessor  : public juce::AudioProcessor
+class VSTSamplerAudioProcessor  : public juce::AudioProcessor,
+                                  private juce::ChangeListener
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -36,6 +49,7 @@ public:
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
+    void editorBeingDeleted(juce::AudioProcessorEditor*) noexcept override;
 
     //==============================================================================
     const juce::String getName() const override;
@@ -55,11 +69,173 @@ public:
     //==============================================================================
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
-    
 
-    juce::AudioTransportSource transport;
+    // Frees files and samples the audio thread has let go of, on the message thread
+    DeferredRelease deferredRelease;
+
+    // Plays the imported file; it lives here so it keeps playing with the editor closed
+    FilePlayer player { deferredRelease };
+
+    /** Opens the file for playback, stopped at the start, and shows its cached
+        analysis if there is one. Call from the message thread. Returns false,
+        keeping the current file, if it can't be read.
+    */
+    bool loadFile(const juce::File& file);
+    juce::File getLoadedFile() const;
+
+    /** Min/max overview of the loaded file, built in the background or read
+        back from disk. Message thread only.
+    */
+    juce::AudioThumbnail& getThumbnail() noexcept                   { return thumbnail; }
+
+    /** Reopens the current file with the current read-ahead and resampling
+        settings, keeping its position and whether it is playing.
+    */
+    void reloadPlaybackFile();
+
+    /** How far ahead of the play position the imported file is decoded, on the
+        shared streaming thread. Takes effect when the file is next (re)loaded.
+    */
+    void setReadAheadSeconds(double seconds) noexcept               { readAheadSeconds.store(seconds); }
+    double getReadAheadSeconds() const noexcept                     { return readAheadSeconds.load(); }
+
+    /** Used to convert the imported file to the host's rate as it plays, and
+        samples as they load. Takes effect on the next file or samples loaded.
+    */
+    void setResamplingQuality(PolyphaseResampler::Quality quality) noexcept { resamplingQuality.store(quality); }
+    PolyphaseResampler::Quality getResamplingQuality() const noexcept       { return resamplingQuality.load(); }
+
+    // Where the live chord detector takes its audio from
+    enum class LiveSource
+    {
+        transport,
+        input
+    };
+
+    void setLiveSource(LiveSource newSource) noexcept { liveSource.store(newSource); }
+    LiveSource getLiveSource() const noexcept { return liveSource.load(); }
+
+    LiveChordDetector liveChordDetector;
+
+    /** Turns live detection on or off. While it is on, the output is delayed by
+        the detector's latency and that latency is reported to the host, so the
+        chord shown lines up with the compensated audio.
+    */
+    void setLiveDetectionEnabled(bool shouldBeEnabled);
+
+    // Sends the live chords to the MIDI output, aligned with the delayed audio
+    ChordMidiOutput chordMidiOutput;
+
+    /** Frame and FFT sizes and chroma front end for both analyses, and the
+        offline hop (0 for the preset's own). Call from the message thread;
+        restarts live detection.
+    */
+    void setAnalysisSettings(AnalysisSettings::Preset newPreset, double newOfflineHopSeconds,
+                             AnalysisSettings::Chroma newChroma);
+    AnalysisSettings::Preset getAnalysisPreset() const noexcept     { return analysisPreset.load(); }
+    double getOfflineHopSeconds() const noexcept                    { return offlineHopSeconds.load(); }
+    AnalysisSettings::Chroma getChroma() const noexcept             { return chroma.load(); }
+
+    /** Viterbi smoothing of the offline chord sequence; live detection is unaffected. */
+    void setSmoothingEnabled(bool shouldSmooth) noexcept            { smoothing.store(shouldSmooth); }
+    bool isSmoothingEnabled() const noexcept                        { return smoothing.load(); }
+
+    /** Offline chords decided once per tracked beat rather than per frame, at
+        the host's tempo when it reports one.
+    */
+    void setBeatSyncEnabled(bool shouldSyncToBeats) noexcept        { beatSync.store(shouldSyncToBeats); }
+    bool isBeatSyncEnabled() const noexcept                         { return beatSync.load(); }
+
+    AnalysisSettings getOfflineAnalysisSettings() const;
+
+    //==============================================================================
+    /** Starts the offline "Chord ID" analysis of the loaded file, split into
+        numChunks jobs on the process-wide analysis service. Message thread
+        only, as are the rest of these.
+    */
+    bool startAnalysis(int numChunks);
+    void cancelAnalysis();
+
+    /** Drops the current result and shows the cached one for the current settings, if any. */
+    void refreshAnalysis();
+
+    /** The running or last finished analysis, or nullptr. */
+    const OfflineChordAnalysis* getAnalysis() const noexcept        { return analysis.get(); }
+
+    /** The finished analysis of the loaded file, or nullptr. */
+    const ChordTimeline* getTimeline();
+
+    int getMaxAnalysisThreads() const noexcept                      { return analysisClient.getNumThreads(); }
+
+    // Plays the loaded samples from incoming MIDI, mixed over the imported file
+    SamplerEngine sampler;
+
+    /** Decodes the files into a new sample pool, at the host's sample rate if
+        it is known, and gives it to the sampler. Call from the message thread.
+        Returns false, and keeps the current samples, if none of the files could be read.
+    */
+    bool loadSamples(const juce::Array<juce::File>& files, juce::StringArray* errors = nullptr);
+    const juce::Array<juce::File>& getSampleFiles() const noexcept  { return sampleFiles; }
+
+    // processBlock timing against the block deadline, for the editor's overlay
+    Instrumentation::BlockStats blockStats;
+
+    // Finished offline analyses, shared by every editor this processor opens
+    ChordAnalysisCache analysisCache;
+
+    // The imported file and the cache key of its analysis, saved with the session
+    struct LoadedFileState
+    {
+        juce::File file;
+        juce::Time modificationTime;
+        juce::String analysisCacheKey;
+    };
+
+    void setLoadedFileState(const LoadedFileState& newState);
+    LoadedFileState getLoadedFileState() const;
 
 private:
+    void changeListenerCallback(juce::ChangeBroadcaster*) override;
+    void updateAnalysisPriority();
+    AnalysisSettings getLiveSettings() const;
+    void updateLatency();
+    void lookUpCachedAnalysis();
+
+    std::atomic<LiveSource> liveSource { LiveSource::transport };
+
+    juce::AudioFormatManager formatManager;
+    juce::Array<juce::File> sampleFiles;     // message thread only
+
+    // One pixel column of the overview per 512 samples; shared cache, kept on disk
+    juce::SharedResourcePointer<PersistentThumbnailCache> thumbnailCache;
+    juce::AudioThumbnail thumbnail { 512, formatManager, *thumbnailCache };
+
+    // Offline "Chord ID" analysis runs on threads shared with every other instance,
+    // ahead of theirs while we are playing or our editor is open
+    SharedAnalysisService::Client analysisClient;
+    bool editorOpen = false;    // message thread only
+    std::unique_ptr<OfflineChordAnalysis> analysis;
+    ChordTimeline::Mailbox timelineMailbox;
+    std::unique_ptr<ChordTimeline> timeline;
+
+    std::atomic<AnalysisSettings::Preset> analysisPreset { AnalysisSettings::Preset::standard };
+    std::atomic<double> offlineHopSeconds { 0.0 };
+    std::atomic<AnalysisSettings::Chroma> chroma { AnalysisSettings::Chroma::peaks };
+    std::atomic<bool> smoothing { false }, beatSync { false };
+    std::atomic<double> hostTempo { 0.0 };     // while the host plays, 0 until it has
+    std::atomic<double> readAheadSeconds { ReadAheadAudioSource::defaultReadAheadSeconds };
+    std::atomic<PolyphaseResampler::Quality> resamplingQuality { PolyphaseResampler::Quality::normal };
+
+    // Keeps the output aligned with the live chord when latency is reported
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> outputDelay;
+    std::atomic<int> outputDelaySamples { 0 };
+    int appliedDelaySamples = 0, fadeFromDelaySamples = 0;     // audio thread only
+    int delayFadeLength = 1, delayFadeRemaining = 0;
+
+    juce::CriticalSection loadedFileLock;
+    LoadedFileState loadedFileState;
+
     //==============================================================================
+    JUCE_DECLARE_WEAK_REFERENCEABLE (VSTSamplerAudioProcessor)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VSTSamplerAudioProcessor)
 };
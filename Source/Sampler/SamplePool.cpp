@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    SamplePool.cpp
+
+  ==============================================================================
+*/
+
+#include "SamplePool.h"
+#include <algorithm>
+
+std::shared_ptr<const SamplePool> SamplePool::loadFromFiles(juce::AudioFormatManager& formatManager,
+                                                            const juce::Array<juce::File>& files,
+                                                            juce::StringArray* errors,
+                                                            double targetSampleRate,
+                                                            PolyphaseResampler::Quality quality)
+{
+    std::vector<Sample> samples;
+
+    auto reportError = [errors] (const juce::String& message)
+    {
+        if (errors != nullptr)
+            errors->add(message);
+    };
+
+    for (auto& file : files)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+        if (reader == nullptr)
+        {
+            reportError("Can't read " + file.getFileName());
+            continue;
+        }
+
+        if (reader->lengthInSamples < 2 || reader->lengthInSamples > (juce::int64) (maxLengthSeconds * reader->sampleRate))
+        {
+            reportError(file.getFileName() + " is empty or longer than " + juce::String((int) maxLengthSeconds) + " seconds");
+            continue;
+        }
+
+        Sample sample;
+        sample.name = file.getFileNameWithoutExtension();
+        sample.sampleRate = reader->sampleRate;
+        sample.rootNote = parseRootNote(sample.name);
+        sample.audio.setSize(juce::jmin(2, (int) reader->numChannels), (int) reader->lengthInSamples);
+        reader->read(&sample.audio, 0, (int) reader->lengthInSamples, 0, true, sample.audio.getNumChannels() > 1);
+
+        // Converted once here rather than on every note
+        if (targetSampleRate > 0.0 && targetSampleRate != sample.sampleRate)
+        {
+            sample.audio = PolyphaseResampler::resampleBuffer(sample.audio, sample.sampleRate / targetSampleRate, quality);
+            sample.sampleRate = targetSampleRate;
+        }
+
+        samples.push_back(std::move(sample));
+    }
+
+    if (samples.empty())
+        return {};
+
+    return std::make_shared<const SamplePool>(std::move(samples));
+}
+
+SamplePool::SamplePool(std::vector<Sample> samplesToUse)
+    : samples(std::move(samplesToUse))
+{
+    std::stable_sort(samples.begin(), samples.end(), [] (const Sample& a, const Sample& b)
+    {
+        return a.rootNote < b.rootNote;
+    });
+
+    // Each sample reaches halfway to its neighbours' roots; the outermost ones reach the ends
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        samples[i].lowNote = i == 0 ? 0 : (samples[i - 1].rootNote + samples[i].rootNote) / 2 + 1;
+        samples[i].highNote = i + 1 == samples.size() ? 127 : (samples[i].rootNote + samples[i + 1].rootNote) / 2;
+    }
+
+    sampleForNote.fill(-1);
+
+    for (size_t i = 0; i < samples.size(); ++i)
+        for (int note = juce::jmax(0, samples[i].lowNote); note <= juce::jmin(127, samples[i].highNote); ++note)
+            sampleForNote[(size_t) note] = (juce::int16) i;
+}
+
+int SamplePool::parseRootNote(const juce::String& name, int defaultNote)
+{
+    // Trailing digits, optionally negative for octave -1
+    const int end = name.length();
+    int start = end;
+
+    while (start > 0 && juce::CharacterFunctions::isDigit(name[start - 1]))
+        --start;
+
+    if (start == end)
+        return defaultNote;
+
+    const bool negative = start > 0 && name[start - 1] == '-';
+    const int number = name.substring(start, end).getIntValue();
+    int pos = negative ? start - 1 : start;
+
+    // An optional accidental, then a note letter, makes it a note name
+    int accidental = 0;
+
+    if (pos > 0 && (name[pos - 1] == '#' || name[pos - 1] == 'b'))
+    {
+        accidental = name[pos - 1] == '#' ? 1 : -1;
+        --pos;
+    }
+
+    static constexpr int letterPitchClasses[] = { 9, 11, 0, 2, 4, 5, 7 };   // A to G
+    const auto letter = pos > 0 ? juce::CharacterFunctions::toUpperCase(name[pos - 1]) : 0;
+    const bool letterIsStandalone = pos < 2 || ! juce::CharacterFunctions::isLetter(name[pos - 2]);
+
+    if (letter >= 'A' && letter <= 'G' && letterIsStandalone)
+    {
+        const int octave = negative ? -number : number;
+        const int note = (octave + 1) * 12 + letterPitchClasses[letter - 'A'] + accidental;
+        return juce::isPositiveAndBelow(note, 128) ? note : defaultNote;
+    }
+
+    // A bare number is a MIDI note, unless it's part of a word such as "Take2"
+    if ((start == 0 || ! juce::CharacterFunctions::isLetter(name[start - 1])) && juce::isPositiveAndBelow(number, 128))
+        return number;
+
+    return defaultNote;
+}
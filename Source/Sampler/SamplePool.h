@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    SamplePool.h
+
+    The samples the sampler plays, fully decoded into memory and mapped
+    across the keyboard. A pool is built once, off the audio thread, and
+    never changes afterwards; the engine holds it through a shared_ptr to
+    const, so any number of voices can read it without locking.
+
+    Each sample covers a contiguous range of notes around its root. Roots
+    come from the file names ("Piano C4.wav", "pad_60.aif"; C4 = note 60),
+    and each range reaches halfway to the neighbouring roots.
+
+    Given the host's sample rate, loading also converts every sample to it,
+    so a note played at its root reads the sample one-to-one and the engine
+    only interpolates to change pitch.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Playback/PolyphaseResampler.h"
+#include <array>
+#include <memory>
+#include <vector>
+
+class SamplePool
+{
+public:
+    struct Sample
+    {
+        juce::String name;
+        juce::AudioBuffer<float> audio;     // one or two channels
+        double sampleRate = 44100.0;
+        int rootNote = defaultRootNote;
+        int lowNote = 0, highNote = 127;
+    };
+
+    static constexpr int defaultRootNote = 60;
+
+    // Longer files are skipped: everything is decoded into memory up front
+    static constexpr double maxLengthSeconds = 300.0;
+
+    /** Decodes the files and maps them across the keyboard. Files that can't be
+        read are skipped and reported in errors. Returns nullptr if none could be read.
+        If targetSampleRate is above 0, samples at other rates are resampled to it.
+    */
+    static std::shared_ptr<const SamplePool> loadFromFiles(juce::AudioFormatManager&,
+                                                           const juce::Array<juce::File>& files,
+                                                           juce::StringArray* errors = nullptr,
+                                                           double targetSampleRate = 0.0,
+                                                           PolyphaseResampler::Quality = PolyphaseResampler::Quality::high);
+
+    /** Takes samples with their root notes set and assigns their note ranges. */
+    explicit SamplePool(std::vector<Sample> samples);
+
+    int getNumSamples() const noexcept                      { return (int) samples.size(); }
+    const Sample& getSample(int index) const noexcept       { return samples[(size_t) index]; }
+
+    /** The sample mapped to a MIDI note, or nullptr. A table look-up, safe on the audio thread. */
+    const Sample* getSampleForNote(int note) const noexcept
+    {
+        if (! juce::isPositiveAndBelow(note, 128))
+            return nullptr;
+
+        const auto index = sampleForNote[(size_t) note];
+        return index >= 0 ? &samples[(size_t) index] : nullptr;
+    }
+
+    /** Reads a root note from the end of a file name, as a note name ("F#3") or
+        a MIDI note number ("60"). Returns defaultNote if there is neither.
+    */
+    static int parseRootNote(const juce::String& fileNameWithoutExtension, int defaultNote = defaultRootNote);
+
+private:
+    std::vector<Sample> samples;
+    std::array<juce::int16, 128> sampleForNote;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplePool)
+};
@@ -0,0 +1,308 @@
+/*
+  ==============================================================================
+
+    SamplerEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "SamplerEngine.h"
+
+void SamplerEngine::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    scratchSize = juce::jmax(1, maximumBlockSize);
+    stealFadeSamples = juce::jmax(1, juce::roundToInt(stealFadeSeconds * sampleRate));
+
+    voiceScratch.setSize(2, scratchSize);
+    gainScratch.allocate((size_t) scratchSize, true);
+
+    for (auto& voice : voices)
+        voice.envelope.setSampleRate(sampleRate);
+
+    reset();
+}
+
+std::shared_ptr<const SamplePool> SamplerEngine::setSamplePool(std::shared_ptr<const SamplePool> newPool)
+{
+    // The generation, not the address, tells the audio thread to switch: a new
+    // pool can be allocated where an already released one used to be
+    publishedPool.store(newPool.get(), std::memory_order_relaxed);
+    poolGeneration.fetch_add(1, std::memory_order_release);
+    std::swap(pool, newPool);
+    return newPool;
+}
+
+void SamplerEngine::setEnvelope(const juce::ADSR::Parameters& parameters) noexcept
+{
+    attack.store(parameters.attack);
+    decay.store(parameters.decay);
+    sustain.store(parameters.sustain);
+    release.store(parameters.release);
+}
+
+juce::ADSR::Parameters SamplerEngine::getEnvelope() const noexcept
+{
+    return { attack.load(), decay.load(), sustain.load(), release.load() };
+}
+
+void SamplerEngine::reset() noexcept
+{
+    for (auto& voice : voices)
+    {
+        voice.sample = nullptr;
+        voice.keyDown = voice.sustained = voice.fadingOut = false;
+        voice.envelope.reset();
+    }
+
+    sustainPedalDown = false;
+    numActiveVoices.store(0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void SamplerEngine::renderNextBlock(juce::AudioBuffer<float>& output, const juce::MidiBuffer& midi, int startSample, int numSamples) noexcept
+{
+    if (scratchSize == 0)
+        return;
+
+    // Voices point into the pool they started from, so a new pool silences them
+    if (const auto generation = poolGeneration.load(std::memory_order_acquire); generation != activeGeneration)
+    {
+        reset();
+        activePool = publishedPool.load(std::memory_order_relaxed);
+        activeGeneration = generation;
+    }
+
+    // Renders every sounding voice over [start, start + num), in scratch-sized pieces
+    auto renderVoices = [this, &output] (int start, int num)
+    {
+        while (num > 0)
+        {
+            const int chunk = juce::jmin(num, scratchSize);
+
+            for (auto& voice : voices)
+                if (voice.sample != nullptr)
+                    renderVoice(voice, output, start, chunk);
+
+            start += chunk;
+            num -= chunk;
+        }
+    };
+
+    // Split the block at each MIDI event so notes start on their exact sample
+    const int endSample = startSample + numSamples;
+    int position = startSample;
+
+    for (auto it = midi.findNextSamplePosition(startSample); it != midi.cend(); ++it)
+    {
+        const auto metadata = *it;
+
+        if (metadata.samplePosition >= endSample)
+            break;
+
+        renderVoices(position, metadata.samplePosition - position);
+        position = metadata.samplePosition;
+        handleMidiEvent(metadata.getMessage());
+    }
+
+    renderVoices(position, endSample - position);
+
+    int numActive = 0;
+    for (auto& voice : voices)
+        numActive += voice.sample != nullptr ? 1 : 0;
+
+    numActiveVoices.store(numActive, std::memory_order_relaxed);
+}
+
+void SamplerEngine::renderVoice(Voice& voice, juce::AudioBuffer<float>& output, int startSample, int numSamples) noexcept
+{
+    const auto& sample = *voice.sample;
+    const int length = sample.audio.getNumSamples();
+    const int numSourceChannels = sample.audio.getNumChannels();
+
+    // Output samples left before the read position runs past the last pair of source samples
+    const double remaining = (length - 1 - voice.position) / voice.increment;
+    int numToRender = juce::jlimit(0, numSamples, (int) std::ceil(remaining));
+
+    if (voice.fadingOut)
+        numToRender = juce::jmin(numToRender, voice.fadeRemaining);
+
+    if (numToRender > 0)
+    {
+        // Linear interpolation into scratch, one channel at a time
+        for (int channel = 0; channel < numSourceChannels; ++channel)
+        {
+            const float* source = sample.audio.getReadPointer(channel);
+            float* dest = voiceScratch.getWritePointer(channel);
+            double position = voice.position;
+
+            for (int i = 0; i < numToRender; ++i)
+            {
+                const int index = juce::jmin((int) position, length - 2);
+                const float fraction = (float) (position - index);
+                dest[i] = source[index] + fraction * (source[index + 1] - source[index]);
+                position += voice.increment;
+            }
+        }
+
+        voice.position += numToRender * voice.increment;
+
+        // One gain curve for all channels, then a vectorised multiply-add per channel
+        float* gains = gainScratch.getData();
+
+        for (int i = 0; i < numToRender; ++i)
+            gains[i] = voice.envelope.getNextSample();
+
+        juce::FloatVectorOperations::multiply(gains, voice.gain, numToRender);
+
+        // A linear ramp down to silence over the rest of a stolen voice's fade
+        if (voice.fadingOut)
+        {
+            for (int i = 0; i < numToRender; ++i)
+                gains[i] *= (float) (voice.fadeRemaining - i) / (float) stealFadeSamples;
+
+            voice.fadeRemaining -= numToRender;
+        }
+
+        for (int channel = 0; channel < output.getNumChannels(); ++channel)
+            juce::FloatVectorOperations::addWithMultiply(output.getWritePointer(channel, startSample),
+                                                         voiceScratch.getReadPointer(juce::jmin(channel, numSourceChannels - 1)),
+                                                         gains, numToRender);
+    }
+
+    if (numToRender < numSamples || ! voice.envelope.isActive() || (voice.fadingOut && voice.fadeRemaining <= 0))
+    {
+        voice.sample = nullptr;
+        voice.fadingOut = false;
+        voice.envelope.reset();
+    }
+}
+
+//==============================================================================
+void SamplerEngine::handleMidiEvent(const juce::MidiMessage& message) noexcept
+{
+    if (message.isNoteOn())
+        noteOn(message.getNoteNumber(), message.getFloatVelocity());
+    else if (message.isNoteOff())
+        noteOff(message.getNoteNumber());
+    else if (message.isSustainPedalOn())
+        setSustainPedal(true);
+    else if (message.isSustainPedalOff())
+        setSustainPedal(false);
+    else if (message.isAllSoundOff())
+        reset();
+    else if (message.isAllNotesOff())
+        for (auto& voice : voices)
+            if (voice.sample != nullptr)
+                noteOff(voice.note);
+}
+
+void SamplerEngine::noteOn(int note, float velocity) noexcept
+{
+    if (activePool == nullptr)
+        return;
+
+    const auto* sample = activePool->getSampleForNote(note);
+
+    if (sample == nullptr)
+        return;
+
+    auto& voice = findVoiceToUse();
+    voice.sample = sample;
+    voice.note = note;
+    voice.position = 0.0;
+    voice.increment = std::pow(2.0, (note - sample->rootNote) / 12.0) * sample->sampleRate / sampleRate;
+    voice.gain = velocity;
+    voice.startOrder = nextStartOrder++;
+    voice.keyDown = true;
+    voice.sustained = false;
+    voice.fadingOut = false;
+
+    voice.envelope.setParameters(getEnvelope());
+    voice.envelope.reset();
+    voice.envelope.noteOn();
+}
+
+void SamplerEngine::noteOff(int note) noexcept
+{
+    for (auto& voice : voices)
+    {
+        if (voice.sample == nullptr || voice.note != note || ! voice.keyDown)
+            continue;
+
+        voice.keyDown = false;
+
+        if (sustainPedalDown)
+            voice.sustained = true;
+        else
+            voice.envelope.noteOff();
+    }
+}
+
+void SamplerEngine::setSustainPedal(bool isDown) noexcept
+{
+    sustainPedalDown = isDown;
+
+    if (isDown)
+        return;
+
+    for (auto& voice : voices)
+    {
+        if (voice.sample != nullptr && voice.sustained)
+        {
+            voice.sustained = false;
+            voice.envelope.noteOff();
+        }
+    }
+}
+
+SamplerEngine::Voice& SamplerEngine::findVoiceToUse() noexcept
+{
+    Voice* freeVoice = nullptr;
+    Voice* oldestReleased = nullptr;
+    Voice* oldest = nullptr;
+    Voice* mostFaded = nullptr;
+    int numSounding = 0;
+
+    for (auto& voice : voices)
+    {
+        if (voice.sample == nullptr)
+        {
+            if (freeVoice == nullptr)
+                freeVoice = &voice;
+
+            continue;
+        }
+
+        if (voice.fadingOut)
+        {
+            if (mostFaded == nullptr || voice.fadeRemaining < mostFaded->fadeRemaining)
+                mostFaded = &voice;
+
+            continue;
+        }
+
+        ++numSounding;
+
+        if (oldest == nullptr || voice.startOrder < oldest->startOrder)
+            oldest = &voice;
+
+        if (! voice.keyDown && (oldestReleased == nullptr || voice.startOrder < oldestReleased->startOrder))
+            oldestReleased = &voice;
+    }
+
+    if (numSounding >= maxVoices)
+        startStealFade(oldestReleased != nullptr ? *oldestReleased : *oldest);
+
+    // Only when every spare voice is still fading does a fade get cut short,
+    // and then the one closest to silence
+    return freeVoice != nullptr ? *freeVoice : *mostFaded;
+}
+
+void SamplerEngine::startStealFade(Voice& voice) noexcept
+{
+    // Out of reach of note-offs and the pedal; the envelope carries on under the ramp
+    voice.keyDown = voice.sustained = false;
+    voice.fadingOut = true;
+    voice.fadeRemaining = stealFadeSamples;
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    SamplerEngine.h
+
+    Plays the SamplePool polyphonically from MIDI: each note-on takes a voice
+    from a fixed pool, picks the sample mapped to the note, and resamples it
+    by the note's distance from the sample's root, shaped by a juce::ADSR and
+    scaled by velocity. The sustain pedal holds released notes.
+
+    All voices and scratch buffers are allocated in prepare(), so rendering
+    never allocates. New samples are published through an atomic pointer and
+    picked up at the start of a block, so swapping them never blocks.
+    A voice renders a whole run of samples at a time: interpolate into a
+    scratch buffer, build the envelope x velocity gain curve, then
+    one vectorised multiply-add per output channel.
+
+    When every voice is busy, a note-on steals the voice that was started
+    longest ago, preferring voices whose key is already up, so the choice
+    only depends on the order of the MIDI events. The stolen note is not cut
+    off, which would click: it fades out over a few milliseconds in one of a
+    few spare voices while the new note starts in a free one.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SamplePool.h"
+#include <array>
+#include <atomic>
+#include <memory>
+
+class SamplerEngine
+{
+public:
+    static constexpr int maxVoices = 64;
+    static constexpr int numTailVoices = 8;             // spare, for stolen notes to fade out in
+    static constexpr double stealFadeSeconds = 0.005;
+
+    SamplerEngine() = default;
+
+    /** Allocates scratch space for blocks of up to maximumBlockSize samples. */
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    /** Publishes new samples without locking: the next renderNextBlock()
+        silences the voices still playing the old ones and switches over.
+        Returns the previous pool, which the audio thread may be reading until
+        its current block ends; keep it alive until then (see DeferredRelease).
+        Call from one thread only, normally the message thread.
+    */
+    std::shared_ptr<const SamplePool> setSamplePool(std::shared_ptr<const SamplePool> newPool);
+    std::shared_ptr<const SamplePool> getSamplePool() const     { return pool; }
+
+    /** Takes effect from the next note-on. Safe from any thread. */
+    void setEnvelope(const juce::ADSR::Parameters&) noexcept;
+    juce::ADSR::Parameters getEnvelope() const noexcept;
+
+    /** Adds the voices to the output and handles the MIDI events in between. Allocation-free. */
+    void renderNextBlock(juce::AudioBuffer<float>& output, const juce::MidiBuffer& midi, int startSample, int numSamples) noexcept;
+
+    /** Stops every voice immediately. */
+    void reset() noexcept;
+
+    /** Sounding voices, for display. */
+    int getNumActiveVoices() const noexcept     { return numActiveVoices.load(std::memory_order_relaxed); }
+
+private:
+    struct Voice
+    {
+        const SamplePool::Sample* sample = nullptr;     // nullptr when the voice is free
+        int note = -1;
+        double position = 0.0, increment = 1.0;
+        float gain = 0.0f;
+        juce::uint32 startOrder = 0;
+        bool keyDown = false, sustained = false;
+        bool fadingOut = false;         // stolen, fading over the last fadeRemaining samples
+        int fadeRemaining = 0;
+        juce::ADSR envelope;
+    };
+
+    void handleMidiEvent(const juce::MidiMessage&) noexcept;
+    void noteOn(int note, float velocity) noexcept;
+    void noteOff(int note) noexcept;
+    void setSustainPedal(bool isDown) noexcept;
+    Voice& findVoiceToUse() noexcept;
+    void startStealFade(Voice&) noexcept;
+    void renderVoice(Voice&, juce::AudioBuffer<float>& output, int startSample, int numSamples) noexcept;
+
+    std::shared_ptr<const SamplePool> pool;                     // owned by the publishing thread
+    std::atomic<const SamplePool*> publishedPool { nullptr };
+    std::atomic<juce::uint32> poolGeneration { 0 };
+    const SamplePool* activePool = nullptr;                     // audio thread only
+    juce::uint32 activeGeneration = 0;                          // audio thread only
+    std::array<Voice, maxVoices + numTailVoices> voices;
+    juce::uint32 nextStartOrder = 0;
+    bool sustainPedalDown = false;
+    double sampleRate = 44100.0;
+    int stealFadeSamples = 1;
+
+    juce::AudioBuffer<float> voiceScratch;      // interpolated sample, per channel
+    juce::HeapBlock<float> gainScratch;         // envelope x velocity
+    int scratchSize = 0;
+
+    std::atomic<float> attack { 0.005f }, decay { 0.1f }, sustain { 1.0f }, release { 0.2f };
+    std::atomic<int> numActiveVoices { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerEngine)
+};
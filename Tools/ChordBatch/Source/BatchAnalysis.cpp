@@ -0,0 +1,220 @@
+/*
+  ==============================================================================
+
+    BatchAnalysis.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchAnalysis.h"
+#include "../../../Source/Analysis/ChordDetection.h"
+#include "../../../Source/Analysis/ChordTimeline.h"
+#include "../../../Source/Analysis/OfflineChordAnalysis.h"
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    // Files are split into one chunk job per this many bytes, up to one per thread
+    constexpr juce::int64 bytesPerChunk = 32 * 1024 * 1024;
+
+    // Files queued ahead of the pool, per thread, so a thread never waits for the next file
+    constexpr int filesInFlightPerThread = 2;
+
+    juce::String getChordLabel(int chordIndex)
+    {
+        const auto name = chordIndex >= 0 ? ChordDetection::getChordName(chordIndex) : juce::String();
+        return name.isNotEmpty() ? name : juce::String("N");
+    }
+
+    juce::String formatSeconds(juce::int64 sample, double sampleRate)
+    {
+        return juce::String((double) sample / sampleRate, 3);
+    }
+}
+
+//==============================================================================
+struct BatchAnalysis::Item
+{
+    juce::File file;
+    std::unique_ptr<OfflineChordAnalysis> analysis;
+};
+
+BatchAnalysis::BatchAnalysis(const Options& o)
+    : options(o)
+{
+    formatManager.registerBasicFormats();
+}
+
+juce::Array<juce::File> BatchAnalysis::findFiles() const
+{
+    const auto wildcard = formatManager.getWildcardForAllFormats();
+    juce::Array<juce::File> files;
+
+    for (auto& input : options.inputs)
+    {
+        if (input.isDirectory())
+        {
+            for (const auto& entry : juce::RangedDirectoryIterator(input, true, wildcard, juce::File::findFiles))
+                files.addIfNotAlreadyThere(entry.getFile());
+        }
+        else if (input.existsAsFile())
+        {
+            files.addIfNotAlreadyThere(input);
+        }
+        else
+        {
+            std::cerr << "Not found: " << input.getFullPathName() << std::endl;
+        }
+    }
+
+    // Longest jobs first, so the last ones to finish are short
+    std::sort(files.begin(), files.end(), [] (const juce::File& a, const juce::File& b)
+    {
+        return a.getSize() > b.getSize();
+    });
+
+    return files;
+}
+
+BatchAnalysis::Summary BatchAnalysis::run(const juce::Array<juce::File>& files)
+{
+    Summary summary;
+    summary.numFiles = files.size();
+
+    const int numThreads = juce::jmax(1, options.numThreads);
+    const int maxInFlight = numThreads * filesInFlightPerThread;
+    juce::ThreadPool pool(numThreads);
+
+    std::vector<std::unique_ptr<Item>> inFlight;
+    int nextFile = 0;
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    while (nextFile < files.size() || ! inFlight.empty())
+    {
+        while (nextFile < files.size() && (int) inFlight.size() < maxInFlight)
+        {
+            auto item = std::make_unique<Item>();
+            item->file = files.getReference(nextFile++);
+            item->analysis = std::make_unique<OfflineChordAnalysis>(item->file, options.settings);
+
+            const auto numChunks = (int) juce::jlimit((juce::int64) 1, (juce::int64) numThreads,
+                                                      item->file.getSize() / bytesPerChunk + 1);
+            item->analysis->start(pool, numChunks);
+            inFlight.push_back(std::move(item));
+        }
+
+        bool anyFinished = false;
+
+        for (auto it = inFlight.begin(); it != inFlight.end();)
+        {
+            auto& item = **it;
+
+            if (! item.analysis->isFinished())
+            {
+                ++it;
+                continue;
+            }
+
+            const auto& analysis = *item.analysis;
+            const bool ok = ! analysis.failedToOpen() && writeResult(item);
+
+            if (ok)
+                summary.audioSeconds += (double) analysis.getTotalFrames() * analysis.getStepSize() / analysis.getSampleRate();
+            else
+                ++summary.numFailed;
+
+            if (options.verbose || ! ok)
+                std::cout << (ok ? "done   " : "FAILED ") << item.file.getFullPathName() << std::endl;
+
+            it = inFlight.erase(it);
+            anyFinished = true;
+        }
+
+        if (! anyFinished)
+            juce::Thread::sleep(2);
+    }
+
+    summary.wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    return summary;
+}
+
+juce::File BatchAnalysis::getOutputFileFor(const juce::File& input) const
+{
+    // Mirror the layout under whichever input directory the file came from
+    auto relativePath = input.getFileName();
+
+    for (auto& root : options.inputs)
+    {
+        if (root.isDirectory() && input.isAChildOf(root))
+        {
+            relativePath = input.getRelativePathFrom(root);
+            break;
+        }
+    }
+
+    return options.outputDirectory.getChildFile(relativePath + (options.format == OutputFormat::json ? ".json" : ".csv"));
+}
+
+bool BatchAnalysis::writeResult(const Item& item) const
+{
+    const auto& analysis = *item.analysis;
+    const auto timeline = analysis.createTimeline();
+    const auto sampleRate = timeline->getSampleRate();
+    const auto endSample = (juce::int64) analysis.getTotalFrames() * analysis.getStepSize();
+
+    auto getSegmentEnd = [&] (int index)
+    {
+        return index + 1 < timeline->getNumSegments() ? timeline->getSegment(index + 1).startSample : endSample;
+    };
+
+    juce::String text;
+
+    if (options.format == OutputFormat::json)
+    {
+        juce::Array<juce::var> segments;
+
+        for (int i = 0; i < timeline->getNumSegments(); ++i)
+        {
+            const auto segment = timeline->getSegment(i);
+
+            auto* object = new juce::DynamicObject();
+            object->setProperty("start", (double) segment.startSample / sampleRate);
+            object->setProperty("end", (double) getSegmentEnd(i) / sampleRate);
+            object->setProperty("chord", getChordLabel(segment.chordIndex));
+            object->setProperty("confidence", segment.confidence);
+            segments.add(juce::var(object));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("file", item.file.getFullPathName());
+        root->setProperty("sampleRate", sampleRate);
+        root->setProperty("parameters", OfflineChordAnalysis::getParameterSignature(analysis.getSettings()));
+
+        if (analysis.getSettings().beatSync)
+            root->setProperty("tempo", analysis.getTempo());
+
+        root->setProperty("segments", segments);
+        text = juce::JSON::toString(juce::var(root));
+    }
+    else
+    {
+        text << "start,end,chord,confidence\n";
+
+        for (int i = 0; i < timeline->getNumSegments(); ++i)
+        {
+            const auto segment = timeline->getSegment(i);
+
+            text << formatSeconds(segment.startSample, sampleRate) << ','
+                 << formatSeconds(getSegmentEnd(i), sampleRate) << ','
+                 << getChordLabel(segment.chordIndex) << ','
+                 << juce::String(segment.confidence, 3) << '\n';
+        }
+    }
+
+    const auto outputFile = getOutputFileFor(item.file);
+
+    return outputFile.getParentDirectory().createDirectory().wasOk()
+        && outputFile.replaceWithText(text);
+}
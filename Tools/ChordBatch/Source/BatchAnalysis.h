@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    BatchAnalysis.h
+
+    Runs the offline chord analysis over a whole catalogue without a GUI.
+    Every file becomes an OfflineChordAnalysis on one shared ThreadPool; long
+    files are split into several chunk jobs so the pool stays busy until the
+    very end instead of waiting on one big file. Only a bounded number of
+    files are in flight at once, and each one's timeline is written out (and
+    its frames freed) as soon as it finishes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/Analysis/AnalysisSettings.h"
+
+class BatchAnalysis
+{
+public:
+    enum class OutputFormat { csv, json };
+
+    struct Options
+    {
+        juce::Array<juce::File> inputs;     // files and/or directories (searched recursively)
+        juce::File outputDirectory;
+        OutputFormat format = OutputFormat::csv;
+        AnalysisSettings settings;
+        int numThreads = juce::SystemStats::getNumCpus();
+        bool verbose = false;
+    };
+
+    struct Summary
+    {
+        int numFiles = 0, numFailed = 0;
+        double audioSeconds = 0.0, wallSeconds = 0.0;
+
+        /** Audio-hours analysed per wall-clock minute. */
+        double getThroughput() const noexcept   { return wallSeconds > 0.0 ? (audioSeconds / 3600.0) / (wallSeconds / 60.0) : 0.0; }
+    };
+
+    explicit BatchAnalysis(const Options&);
+
+    /** Expands the inputs into the list of audio files to analyse, largest first. */
+    juce::Array<juce::File> findFiles() const;
+
+    Summary run(const juce::Array<juce::File>& files);
+
+private:
+    struct Item;
+
+    juce::File getOutputFileFor(const juce::File& input) const;
+    bool writeResult(const Item&) const;
+
+    const Options options;
+    juce::AudioFormatManager formatManager;
+
+    JUCE_DECLARE_NON_COPYABLE (BatchAnalysis)
+};
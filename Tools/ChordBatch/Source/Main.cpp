@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Headless batch chord extraction: analyses every audio file in the given
+    directories or file lists and writes one chord timeline per file.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BatchAnalysis.h"
+#include <iostream>
+
+namespace
+{
+    juce::File resolvePath(const juce::String& path)
+    {
+        return juce::File::getCurrentWorkingDirectory().getChildFile(path.unquoted());
+    }
+
+    void addFilesFromList(const juce::File& listFile, juce::Array<juce::File>& inputs)
+    {
+        if (! listFile.existsAsFile())
+            juce::ConsoleApplication::fail("Can't read file list " + listFile.getFullPathName());
+
+        juce::StringArray lines;
+        listFile.readLines(lines);
+
+        for (auto& line : lines)
+            if (line.trim().isNotEmpty())
+                inputs.add(resolvePath(line.trim()));
+    }
+
+    void runBatch(const juce::ArgumentList& arguments)
+    {
+        // Options (and their values) are removed as they are read; what's left are the inputs
+        auto args = arguments;
+        BatchAnalysis::Options options;
+
+        const auto output = args.removeValueForOption("--output|-o");
+        options.outputDirectory = output.isNotEmpty() ? resolvePath(output) : juce::File::getCurrentWorkingDirectory();
+
+        if (! options.outputDirectory.createDirectory().wasOk())
+            juce::ConsoleApplication::fail("Can't create output directory " + options.outputDirectory.getFullPathName());
+
+        const auto format = args.removeValueForOption("--format|-f");
+        if (format.isNotEmpty() && format != "csv" && format != "json")
+            juce::ConsoleApplication::fail("Unknown format '" + format + "', expected csv or json");
+
+        options.format = format == "json" ? BatchAnalysis::OutputFormat::json : BatchAnalysis::OutputFormat::csv;
+
+        const auto preset = args.removeValueForOption("--preset|-p");
+        if (preset == "low-latency")
+            options.settings = AnalysisSettings::fromPreset(AnalysisSettings::Preset::lowLatency);
+        else if (preset == "high-resolution")
+            options.settings = AnalysisSettings::fromPreset(AnalysisSettings::Preset::highResolution);
+        else if (preset.isNotEmpty() && preset != "standard")
+            juce::ConsoleApplication::fail("Unknown preset '" + preset + "', expected standard, low-latency or high-resolution");
+
+        const auto hop = args.removeValueForOption("--hop");
+        if (hop.isNotEmpty())
+            options.settings.hopSeconds = juce::jmax(0.001, hop.getDoubleValue());
+
+        const auto chroma = args.removeValueForOption("--chroma");
+        if (chroma == "cq")
+            options.settings.chroma = AnalysisSettings::Chroma::constantQ;
+        else if (chroma.isNotEmpty() && chroma != "peaks")
+            juce::ConsoleApplication::fail("Unknown chroma '" + chroma + "', expected peaks or cq");
+
+        options.settings.smoothing = args.removeOptionIfFound("--smooth|-s");
+
+        // A tempo implies beats; without one it is estimated per file
+        const auto bpm = args.removeValueForOption("--bpm");
+        if (args.removeOptionIfFound("--beats|-b") || bpm.isNotEmpty())
+            options.settings = options.settings.withBeatSync(true, bpm.isNotEmpty() ? juce::jmax(1.0, bpm.getDoubleValue()) : 0.0);
+
+        const auto threads = args.removeValueForOption("--threads|-j");
+        if (threads.isNotEmpty())
+            options.numThreads = juce::jmax(1, threads.getIntValue());
+
+        const auto list = args.removeValueForOption("--list|-l");
+        if (list.isNotEmpty())
+            addFilesFromList(resolvePath(list), options.inputs);
+
+        options.verbose = args.removeOptionIfFound("--verbose|-v");
+
+        for (auto& arg : args.arguments)
+        {
+            if (arg.isOption())
+                juce::ConsoleApplication::fail("Unknown option " + arg.text);
+
+            options.inputs.add(arg.resolveAsFile());
+        }
+
+        if (options.inputs.isEmpty())
+            juce::ConsoleApplication::fail("No input files or directories given");
+
+        BatchAnalysis batch(options);
+        const auto files = batch.findFiles();
+
+        std::cout << "Analysing " << files.size() << " files on " << options.numThreads << " threads" << std::endl;
+
+        const auto summary = batch.run(files);
+
+        std::cout << summary.numFiles - summary.numFailed << " of " << summary.numFiles << " files, "
+                  << juce::String(summary.audioSeconds / 3600.0, 2) << " audio-hours in "
+                  << juce::String(summary.wallSeconds, 1) << " s: "
+                  << juce::String(summary.getThroughput(), 2) << " audio-hours per minute" << std::endl;
+
+        if (summary.numFailed > 0)
+            juce::ConsoleApplication::fail(juce::String(summary.numFailed) + " files failed", 2);
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ConsoleApplication app;
+
+    app.addHelpCommand("--help|-h", "Usage: ChordBatch [options] <file or directory>...", true);
+
+    app.addDefaultCommand({ "", "[options] <file or directory>...",
+                            "Analyses audio files and writes one chord timeline per file",
+                            "Options:\n"
+                            "  --output=<dir>, -o <dir>    where to write the timelines (default: current directory)\n"
+                            "  --format=csv|json, -f ...   output format (default: csv)\n"
+                            "  --preset=<name>, -p <name>  standard, low-latency or high-resolution (default: standard)\n"
+                            "  --hop=<seconds>             step between frames (default: the preset's)\n"
+                            "  --chroma=peaks|cq           spectral peak picking or constant-Q kernel (default: peaks)\n"
+                            "  --smooth, -s                Viterbi-smooth the chord sequence\n"
+                            "  --beats, -b                 one chord per tracked beat, for alignment (not faster)\n"
+                            "  --bpm=<tempo>               track beats at this tempo instead of estimating it\n"
+                            "  --threads=<n>, -j <n>       worker threads (default: one per CPU)\n"
+                            "  --list=<file>, -l <file>    also analyse the files listed in <file>, one path per line\n"
+                            "  --verbose, -v               print every file as it finishes",
+                            runBatch });
+
+    return app.findAndRunCommand(argc, argv);
+}